@@ -21,6 +21,7 @@
 
 #include "gtkboolfilter.h"
 
+#include "gtkfilterprivate.h"
 #include "gtkintl.h"
 #include "gtktypebuiltins.h"
 
@@ -73,6 +74,107 @@ gtk_bool_filter_match (GtkFilter *filter,
   return result;
 }
 
+/* The value of the key if the expression could not be evaluated */
+#define GTK_BOOL_FILTER_KEY_INVALID 2
+
+typedef struct _GtkBoolFilterKeys GtkBoolFilterKeys;
+struct _GtkBoolFilterKeys
+{
+  GtkFilterKeys keys;
+
+  GtkExpression *expression;
+  gboolean invert;
+};
+
+static void
+gtk_bool_filter_keys_free (GtkFilterKeys *keys)
+{
+  GtkBoolFilterKeys *self = (GtkBoolFilterKeys *) keys;
+
+  gtk_expression_unref (self->expression);
+  g_slice_free (GtkBoolFilterKeys, self);
+}
+
+static gboolean
+gtk_bool_filter_keys_match (GtkFilterKeys *keys,
+                            gconstpointer  key_memory)
+{
+  GtkBoolFilterKeys *self = (GtkBoolFilterKeys *) keys;
+  guchar key = *(const guchar *) key_memory;
+
+  if (key == GTK_BOOL_FILTER_KEY_INVALID)
+    return FALSE;
+
+  return self->invert ? !key : key;
+}
+
+static gboolean
+gtk_bool_filter_keys_is_compatible (GtkFilterKeys *keys,
+                                    GtkFilterKeys *other);
+
+static void
+gtk_bool_filter_keys_init_key (GtkFilterKeys *keys,
+                               gpointer       item,
+                               gpointer       key_memory)
+{
+  GtkBoolFilterKeys *self = (GtkBoolFilterKeys *) keys;
+  guchar *key = (guchar *) key_memory;
+  GValue value = G_VALUE_INIT;
+
+  if (gtk_expression_evaluate (self->expression, item, &value))
+    {
+      *key = g_value_get_boolean (&value) ? TRUE : FALSE;
+      g_value_unset (&value);
+    }
+  else
+    {
+      *key = GTK_BOOL_FILTER_KEY_INVALID;
+    }
+}
+
+static const GtkFilterKeysClass GTK_BOOL_FILTER_KEYS_CLASS =
+{
+  gtk_bool_filter_keys_free,
+  gtk_bool_filter_keys_match,
+  gtk_bool_filter_keys_is_compatible,
+  gtk_bool_filter_keys_init_key,
+  NULL
+};
+
+/* Inverting doesn't change the keys, only how they match */
+static gboolean
+gtk_bool_filter_keys_is_compatible (GtkFilterKeys *keys,
+                                    GtkFilterKeys *other)
+{
+  GtkBoolFilterKeys *self = (GtkBoolFilterKeys *) keys;
+  GtkBoolFilterKeys *compare = (GtkBoolFilterKeys *) other;
+
+  if (other->klass != &GTK_BOOL_FILTER_KEYS_CLASS)
+    return FALSE;
+
+  return self->expression == compare->expression;
+}
+
+static GtkFilterKeys *
+gtk_bool_filter_keys_new (GtkBoolFilter *self)
+{
+  GtkBoolFilterKeys *result;
+
+  if (self->expression == NULL)
+    return NULL;
+
+  result = gtk_filter_keys_new (GtkBoolFilterKeys,
+                                &GTK_BOOL_FILTER_KEYS_CLASS,
+                                sizeof (guchar),
+                                sizeof (guchar));
+
+  result->expression = gtk_expression_ref (self->expression);
+  result->invert = self->invert;
+  result->keys.thread_safe = TRUE;
+
+  return (GtkFilterKeys *) result;
+}
+
 static GtkFilterMatch
 gtk_bool_filter_get_strictness (GtkFilter *filter)
 {
@@ -249,7 +351,9 @@ gtk_bool_filter_set_expression (GtkBoolFilter *self,
   if (expression)
     self->expression = gtk_expression_ref (expression);
 
-  gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_DIFFERENT);
+  gtk_filter_changed_with_keys (GTK_FILTER (self),
+                                GTK_FILTER_CHANGE_DIFFERENT,
+                                gtk_bool_filter_keys_new (self));
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_EXPRESSION]);
 }
@@ -288,7 +392,9 @@ gtk_bool_filter_set_invert (GtkBoolFilter *self,
 
   self->invert = invert;
 
-  gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_DIFFERENT);
+  gtk_filter_changed_with_keys (GTK_FILTER (self),
+                                GTK_FILTER_CHANGE_DIFFERENT,
+                                gtk_bool_filter_keys_new (self));
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INVERT]);
 }
@@ -3548,3 +3548,79 @@ _gtk_cell_area_set_cell_data_func_with_proxy (GtkCellArea           *area,
       g_hash_table_insert (priv->cell_info, cell, info);
     }
 }
+
+/* Appends a string to @key that identifies the values the attributes
+ * of @area take for @iter, so that rows with equal keys render the
+ * same. Returns %FALSE if that can't be determined, because a cell
+ * data function is set or a value can't be compared by content.
+ */
+gboolean
+_gtk_cell_area_append_attributes_key (GtkCellArea  *area,
+                                      GtkTreeModel *tree_model,
+                                      GtkTreeIter  *iter,
+                                      GString      *key)
+{
+  GtkCellAreaPrivate *priv = gtk_cell_area_get_instance_private (area);
+  GList              *cells, *l;
+  gboolean            result = TRUE;
+
+  g_return_val_if_fail (GTK_IS_CELL_AREA (area), FALSE);
+  g_return_val_if_fail (GTK_IS_TREE_MODEL (tree_model), FALSE);
+  g_return_val_if_fail (iter != NULL, FALSE);
+
+  cells = gtk_cell_layout_get_cells (GTK_CELL_LAYOUT (area));
+
+  for (l = cells; l && result; l = l->next)
+    {
+      CellInfo *info = g_hash_table_lookup (priv->cell_info, l->data);
+      GSList   *list;
+
+      if (info == NULL)
+        continue;
+
+      if (info->func)
+        result = FALSE;
+
+      for (list = info->attributes; list && result; list = list->next)
+        {
+          CellAttribute *attribute = list->data;
+          GValue         value = G_VALUE_INIT;
+          char          *contents;
+
+          gtk_tree_model_get_value (tree_model, iter, attribute->column, &value);
+
+          switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (&value)))
+            {
+            case G_TYPE_BOOLEAN:
+            case G_TYPE_CHAR:
+            case G_TYPE_UCHAR:
+            case G_TYPE_INT:
+            case G_TYPE_UINT:
+            case G_TYPE_LONG:
+            case G_TYPE_ULONG:
+            case G_TYPE_INT64:
+            case G_TYPE_UINT64:
+            case G_TYPE_ENUM:
+            case G_TYPE_FLAGS:
+            case G_TYPE_FLOAT:
+            case G_TYPE_DOUBLE:
+            case G_TYPE_STRING:
+              contents = g_strdup_value_contents (&value);
+              g_string_append_printf (key, "%d=%s\n", attribute->column, contents);
+              g_free (contents);
+              break;
+
+            default:
+              /* Objects and boxed types are only known by their address */
+              result = FALSE;
+              break;
+            }
+
+          g_value_unset (&value);
+        }
+    }
+
+  g_list_free (cells);
+
+  return result;
+}
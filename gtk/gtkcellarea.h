@@ -518,6 +518,12 @@ void                 _gtk_cell_area_set_cell_data_func_with_proxy  (GtkCellArea
 								    GDestroyNotify         destroy,
 								    gpointer               proxy);
 
+/* Used by GtkTreeViewColumn to cache the sizes of rows with equal contents. */
+gboolean             _gtk_cell_area_append_attributes_key          (GtkCellArea           *area,
+								    GtkTreeModel          *tree_model,
+								    GtkTreeIter           *iter,
+								    GString               *key);
+
 G_END_DECLS
 
 #endif /* __GTK_CELL_AREA_H__ */
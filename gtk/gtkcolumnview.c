@@ -151,6 +151,10 @@ gtk_column_list_view_class_init (GtkColumnListViewClass *klass)
   gtk_widget_class_set_accessible_role (widget_class, GTK_ACCESSIBLE_ROLE_LIST);
 }
 
+/* Columns closer than this fraction of the view's width to the visible
+ * area are kept allocated, so that scrolling a bit doesn't reveal gaps.
+ */
+#define GTK_COLUMN_VIEW_VIEWPORT_MARGIN 0.5
 
 struct _GtkColumnView
 {
@@ -411,6 +415,30 @@ gtk_column_view_allocate_columns (GtkColumnView *self,
   return x;
 }
 
+static void
+gtk_column_view_update_viewport (GtkColumnView *self,
+                                 int            x,
+                                 int            width)
+{
+  guint i, n;
+  int start, end;
+
+  start = x - width * GTK_COLUMN_VIEW_VIEWPORT_MARGIN;
+  end = x + width + width * GTK_COLUMN_VIEW_VIEWPORT_MARGIN;
+
+  n = g_list_model_get_n_items (G_LIST_MODEL (self->columns));
+  for (i = 0; i < n; i++)
+    {
+      GtkColumnViewColumn *column;
+      int col_x, col_size;
+
+      column = g_list_model_get_item (G_LIST_MODEL (self->columns), i);
+      gtk_column_view_column_get_allocation (column, &col_x, &col_size);
+      gtk_column_view_column_set_in_viewport (column, col_x + col_size > start && col_x < end);
+      g_object_unref (column);
+    }
+}
+
 static void
 gtk_column_view_allocate (GtkWidget *widget,
                           int        width,
@@ -420,8 +448,9 @@ gtk_column_view_allocate (GtkWidget *widget,
   GtkColumnView *self = GTK_COLUMN_VIEW (widget);
   int full_width, header_height, min, nat, x;
 
-  x = gtk_adjustment_get_value (self->hadjustment);
   full_width = gtk_column_view_allocate_columns (self, width);
+  x = CLAMP (gtk_adjustment_get_value (self->hadjustment), 0, MAX (full_width - width, 0));
+  gtk_column_view_update_viewport (self, x, width);
 
   gtk_widget_measure (self->header, GTK_ORIENTATION_VERTICAL, full_width, &min, &nat, NULL, NULL);
   if (gtk_scrollable_get_vscroll_policy (GTK_SCROLLABLE (self->listview)) == GTK_SCROLL_MINIMUM)
@@ -1637,6 +1666,18 @@ gtk_column_view_get_list_view (GtkColumnView *self)
   return GTK_LIST_VIEW (self->listview);
 }
 
+/* Pooled rows were set up for the old columns, so they must not be
+ * reused after the columns changed.
+ */
+void
+gtk_column_view_clear_pool (GtkColumnView *self)
+{
+  if (self->listview == NULL)
+    return;
+
+  gtk_list_item_manager_clear_pool (gtk_list_base_get_manager (GTK_LIST_BASE (self->listview)));
+}
+
 /**
  * gtk_column_view_get_sorter:
  * @self: a #GtkColumnView
@@ -73,6 +73,7 @@ struct _GtkColumnViewColumn
   guint visible     : 1;
   guint resizable   : 1;
   guint expand      : 1;
+  guint in_viewport : 1;
 
   GMenuModel *menu;
 
@@ -350,6 +351,7 @@ gtk_column_view_column_init (GtkColumnViewColumn *self)
   self->visible = TRUE;
   self->resizable = FALSE;
   self->expand = FALSE;
+  self->in_viewport = TRUE;
   self->fixed_width = -1;
 }
 
@@ -403,6 +405,7 @@ gtk_column_view_column_add_cell (GtkColumnViewColumn *self,
   self->first_cell = cell;
 
   gtk_widget_set_visible (GTK_WIDGET (cell), self->visible);
+  gtk_widget_set_can_target (GTK_WIDGET (cell), self->in_viewport);
   gtk_column_view_column_queue_resize (self);
 }
 
@@ -493,6 +496,52 @@ gtk_column_view_column_allocate (GtkColumnViewColumn *self,
   self->header_position = offset;
 }
 
+/* Cells of columns outside of the visible part of the view are
+ * skipped when allocating and drawing rows, so very wide views only
+ * pay for that part. They are still created and measured, so the row
+ * height doesn't depend on the scroll position.
+ *
+ * Skipped cells keep their last allocation, so they must not be
+ * picked either. They stay mapped, so focus is not affected.
+ *
+ * This is called while the view is allocated, so it must not queue
+ * a resize. Cells that become visible need an allocation though, so
+ * their rows get one queued; the view allocates them right after.
+ */
+void
+gtk_column_view_column_set_in_viewport (GtkColumnViewColumn *self,
+                                        gboolean             in_viewport)
+{
+  GtkColumnViewCell *cell;
+
+  if (self->in_viewport == in_viewport)
+    return;
+
+  self->in_viewport = in_viewport;
+
+  for (cell = self->first_cell; cell; cell = gtk_column_view_cell_get_next (cell))
+    {
+      GtkWidget *row;
+
+      gtk_widget_set_can_target (GTK_WIDGET (cell), in_viewport);
+
+      row = gtk_widget_get_parent (GTK_WIDGET (cell));
+      if (row == NULL)
+        continue;
+
+      if (in_viewport)
+        gtk_widget_queue_allocate (row);
+      else
+        gtk_widget_queue_draw (row);
+    }
+}
+
+gboolean
+gtk_column_view_column_get_in_viewport (GtkColumnViewColumn *self)
+{
+  return self->in_viewport;
+}
+
 void
 gtk_column_view_column_get_allocation (GtkColumnViewColumn *self,
                                        int                 *offset,
@@ -513,6 +562,9 @@ gtk_column_view_column_create_cells (GtkColumnViewColumn *self)
   if (self->first_cell)
     return;
 
+  /* pooled rows would come back without a cell for us */
+  gtk_column_view_clear_pool (self->view);
+
   list = gtk_column_view_get_list_view (GTK_COLUMN_VIEW (self->view));
   for (row = gtk_widget_get_first_child (GTK_WIDGET (list));
        row != NULL;
@@ -537,6 +589,10 @@ gtk_column_view_column_create_cells (GtkColumnViewColumn *self)
 static void
 gtk_column_view_column_remove_cells (GtkColumnViewColumn *self)
 {
+  /* pooled rows still have a cell for us */
+  if (self->view)
+    gtk_column_view_clear_pool (self->view);
+
   while (self->first_cell)
     gtk_column_view_cell_remove (self->first_cell);
 }
@@ -621,6 +677,9 @@ gtk_column_view_column_set_position (GtkColumnViewColumn *self,
 {
   GtkColumnViewCell *cell;
 
+  /* pooled rows have their cells in the old order */
+  gtk_column_view_clear_pool (self->view);
+
   gtk_list_item_widget_reorder_child (gtk_column_view_get_header_widget (self->view),
                                       self->header,
                                       position);
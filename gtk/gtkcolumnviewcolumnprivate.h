@@ -48,6 +48,9 @@ void                    gtk_column_view_column_allocate                 (GtkColu
 void                    gtk_column_view_column_get_allocation           (GtkColumnViewColumn    *self,
                                                                          int                    *offset,
                                                                          int                    *size);
+void                    gtk_column_view_column_set_in_viewport          (GtkColumnViewColumn    *self,
+                                                                         gboolean                in_viewport);
+gboolean                gtk_column_view_column_get_in_viewport          (GtkColumnViewColumn    *self);
 
 void                    gtk_column_view_column_notify_sort              (GtkColumnViewColumn    *self);
 
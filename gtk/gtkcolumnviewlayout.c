@@ -136,6 +136,8 @@ gtk_column_view_layout_allocate (GtkLayoutManager *layout_manager,
       if (GTK_IS_COLUMN_VIEW_CELL (child))
         {
           column = gtk_column_view_cell_get_column (GTK_COLUMN_VIEW_CELL (child));
+          if (!gtk_column_view_column_get_in_viewport (column))
+            continue;
           gtk_column_view_column_get_allocation (column, &col_x, &col_width);
         }
       else
@@ -23,6 +23,7 @@
 
 #include "gtkcolumnviewcolumnprivate.h"
 #include "gtkintl.h"
+#include "gtkmultisorterprivate.h"
 #include "gtktypebuiltins.h"
 
 typedef struct
@@ -140,10 +141,50 @@ gtk_column_view_sorter_class_init (GtkColumnViewSorterClass *class)
   object_class->dispose = gtk_column_view_sorter_dispose;
 }
 
+/* Like the keys of a multi sorter, so that changing the sort
+ * column can reuse the keys of the columns that were sorted by
+ * already.
+ */
+static GtkSortKeys *
+gtk_column_view_sorter_get_keys (GtkColumnViewSorter *self)
+{
+  GSequenceIter *iter;
+  GtkSorter **sorters;
+  gboolean *inverted;
+  guint i, n;
+
+  n = g_sequence_get_length (self->sorters);
+  sorters = g_newa (GtkSorter *, n);
+  inverted = g_newa (gboolean, n);
+
+  for (iter = g_sequence_get_begin_iter (self->sorters), i = 0;
+       !g_sequence_iter_is_end (iter);
+       iter = g_sequence_iter_next (iter), i++)
+    {
+      Sorter *s = g_sequence_get (iter);
+
+      sorters[i] = s->sorter;
+      inverted[i] = s->inverted;
+    }
+
+  return gtk_multi_sort_keys_new ((GtkSorter * const *) sorters, inverted, n);
+}
+
+static void
+gtk_column_view_sorter_changed (GtkColumnViewSorter *self,
+                                GtkSorterChange      change)
+{
+  gtk_sorter_changed_with_keys (GTK_SORTER (self),
+                                change,
+                                gtk_column_view_sorter_get_keys (self));
+}
+
 static void
 gtk_column_view_sorter_init (GtkColumnViewSorter *self)
 {
   self->sorters = g_sequence_new (free_sorter);
+
+  gtk_column_view_sorter_changed (self, GTK_SORTER_CHANGE_DIFFERENT);
 }
 
 GtkColumnViewSorter *
@@ -155,7 +196,14 @@ gtk_column_view_sorter_new (void)
 static void
 gtk_column_view_sorter_changed_cb (GtkSorter *sorter, int change, gpointer data)
 {
-  gtk_sorter_changed (GTK_SORTER (data), GTK_SORTER_CHANGE_DIFFERENT);
+  GtkColumnViewSorter *self = data;
+
+  /* with more than one sorter, ties aren't inverted */
+  if (change != GTK_SORTER_CHANGE_INVERTED ||
+      g_sequence_get_length (self->sorters) != 1)
+    change = GTK_SORTER_CHANGE_DIFFERENT;
+
+  gtk_column_view_sorter_changed (self, change);
 }
 
 static gboolean
@@ -184,6 +232,7 @@ gboolean
 gtk_column_view_sorter_add_column (GtkColumnViewSorter *self,
                                    GtkColumnViewColumn *column)
 {
+  GtkSorterChange change = GTK_SORTER_CHANGE_DIFFERENT;
   GSequenceIter *iter;
   GtkSorter *sorter;
   Sorter *s, *first;
@@ -202,6 +251,8 @@ gtk_column_view_sorter_add_column (GtkColumnViewSorter *self,
       if (first->column == column)
         {
           first->inverted = !first->inverted;
+          if (g_sequence_get_length (self->sorters) == 1)
+            change = GTK_SORTER_CHANGE_INVERTED;
           goto out;
         }
     }
@@ -223,7 +274,7 @@ gtk_column_view_sorter_add_column (GtkColumnViewSorter *self,
     gtk_column_view_column_notify_sort (first->column);
 
 out:
-  gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+  gtk_column_view_sorter_changed (self, change);
 
   gtk_column_view_column_notify_sort (column);
 
@@ -239,7 +290,7 @@ gtk_column_view_sorter_remove_column (GtkColumnViewSorter *self,
 
   if (remove_column (self, column))
     {
-      gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+      gtk_column_view_sorter_changed (self, GTK_SORTER_CHANGE_DIFFERENT);
       gtk_column_view_column_notify_sort (column);
       return TRUE;
     }
@@ -275,7 +326,7 @@ gtk_column_view_sorter_set_column (GtkColumnViewSorter *self,
  
   g_sequence_prepend (self->sorters, s);
 
-  gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+  gtk_column_view_sorter_changed (self, GTK_SORTER_CHANGE_DIFFERENT);
 
   gtk_column_view_column_notify_sort (column);
 
@@ -303,7 +354,7 @@ gtk_column_view_sorter_clear (GtkColumnViewSorter *self)
 
   g_sequence_remove_range (iter, g_sequence_get_end_iter (self->sorters));
 
-  gtk_sorter_changed (GTK_SORTER (self), GTK_SORTER_CHANGE_DIFFERENT);
+  gtk_column_view_sorter_changed (self, GTK_SORTER_CHANGE_DIFFERENT);
 
   gtk_column_view_column_notify_sort (column);
 
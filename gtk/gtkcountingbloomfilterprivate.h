@@ -41,14 +41,30 @@ G_BEGIN_DECLS
  * This implementation is based on similar implementations in web browsers, because it's
  * original use case is the same: Making CSS lookups fast.
  *
- * As such, the number of bits is hardcoded to 12 and the elements in the set
- * are 16bit hash values.  
- * It is possible to use 32bit hash values or a different number of bits, should this
- * be considered useful.
+ * The elements in the set are 32bit hash values. Each of them is mapped to
+ * GTK_COUNTING_BLOOM_FILTER_HASHES buckets out of 2^GTK_COUNTING_BLOOM_FILTER_BITS
+ * using double hashing. Both can be overridden at build time, the defaults of
+ * 12 bits and 2 hashes keep the false positive rate low for the few hundred
+ * names, ids and classes that deep widget trees put into the filter.
  */
 
-/* The number of bits from the hash we care about */
+/* The number of bits used to index the buckets */
+#ifndef GTK_COUNTING_BLOOM_FILTER_BITS
 #define GTK_COUNTING_BLOOM_FILTER_BITS (12)
+#endif
+
+/* The number of buckets each hash value is added to */
+#ifndef GTK_COUNTING_BLOOM_FILTER_HASHES
+#define GTK_COUNTING_BLOOM_FILTER_HASHES (2)
+#endif
+
+#if GTK_COUNTING_BLOOM_FILTER_BITS < 1 || GTK_COUNTING_BLOOM_FILTER_BITS > 16
+#error "GTK_COUNTING_BLOOM_FILTER_BITS must be between 1 and 16"
+#endif
+
+#if GTK_COUNTING_BLOOM_FILTER_HASHES < 1
+#error "GTK_COUNTING_BLOOM_FILTER_HASHES must be at least 1"
+#endif
 
 /* The necessary size of the filter */
 #define GTK_COUNTING_BLOOM_FILTER_SIZE (1 << GTK_COUNTING_BLOOM_FILTER_BITS)
@@ -61,11 +77,11 @@ struct _GtkCountingBloomFilter
 };
 
 static inline void      gtk_counting_bloom_filter_add           (GtkCountingBloomFilter         *self,
-                                                                 guint16                         hash);
+                                                                 guint                           hash);
 static inline void      gtk_counting_bloom_filter_remove        (GtkCountingBloomFilter         *self,
-                                                                 guint16                         hash);
+                                                                 guint                           hash);
 static inline gboolean  gtk_counting_bloom_filter_may_contain   (const GtkCountingBloomFilter   *self,
-                                                                 guint16                         hash);
+                                                                 guint                           hash);
 
 
 /*
@@ -81,6 +97,19 @@ static inline gboolean  gtk_counting_bloom_filter_may_contain   (const GtkCounti
  */
 #define GTK_COUNTING_BLOOM_FILTER_INIT {{0}}
 
+/* The hashes we get are often just multiples of quarks, so mix them
+ * before deriving the buckets from them.
+ */
+static inline guint
+gtk_counting_bloom_filter_get_bucket (guint hash,
+                                      guint n)
+{
+  guint32 h1 = (guint32) hash * 0x9E3779B1u;
+  guint32 h2 = ((guint32) hash * 0x85EBCA77u) | 1;
+
+  return (guint32) (h1 + n * h2) >> (32 - GTK_COUNTING_BLOOM_FILTER_BITS);
+}
+
 /*
  * gtk_counting_bloom_filter_add:
  * @self: a #GtkCountingBloomFilter
@@ -94,14 +123,17 @@ static inline gboolean  gtk_counting_bloom_filter_may_contain   (const GtkCounti
  **/
 static inline void
 gtk_counting_bloom_filter_add (GtkCountingBloomFilter *self,
-                               guint16                 hash)
+                               guint                   hash)
 {
-  guint16 bucket = hash % GTK_COUNTING_BLOOM_FILTER_SIZE;
+  guint n;
 
-  if (self->buckets[bucket] == 255)
-    return;
+  for (n = 0; n < GTK_COUNTING_BLOOM_FILTER_HASHES; n++)
+    {
+      guint bucket = gtk_counting_bloom_filter_get_bucket (hash, n);
 
-  self->buckets[bucket]++;
+      if (self->buckets[bucket] != 255)
+        self->buckets[bucket]++;
+    }
 }
 
 /*
@@ -114,16 +146,21 @@ gtk_counting_bloom_filter_add (GtkCountingBloomFilter *self,
  **/
 static inline void
 gtk_counting_bloom_filter_remove (GtkCountingBloomFilter *self,
-                                  guint16                 hash)
+                                  guint                   hash)
 {
-  guint16 bucket = hash % GTK_COUNTING_BLOOM_FILTER_SIZE;
+  guint n;
 
-  if (self->buckets[bucket] == 255)
-    return;
+  for (n = 0; n < GTK_COUNTING_BLOOM_FILTER_HASHES; n++)
+    {
+      guint bucket = gtk_counting_bloom_filter_get_bucket (hash, n);
 
-  g_assert (self->buckets[bucket] > 0);
+      if (self->buckets[bucket] == 255)
+        continue;
 
-  self->buckets[bucket]--;
+      g_assert (self->buckets[bucket] > 0);
+
+      self->buckets[bucket]--;
+    }
 }
 
 /*
@@ -144,11 +181,17 @@ gtk_counting_bloom_filter_remove (GtkCountingBloomFilter *self,
  **/
 static inline gboolean
 gtk_counting_bloom_filter_may_contain (const GtkCountingBloomFilter *self,
-                                       guint16                       hash)
+                                       guint                         hash)
 {
-  guint16 bucket = hash % GTK_COUNTING_BLOOM_FILTER_SIZE;
+  guint n;
+
+  for (n = 0; n < GTK_COUNTING_BLOOM_FILTER_HASHES; n++)
+    {
+      if (self->buckets[gtk_counting_bloom_filter_get_bucket (hash, n)] == 0)
+        return FALSE;
+    }
 
-  return self->buckets[bucket] != 0;
+  return TRUE;
 }
 
 
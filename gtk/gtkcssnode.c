@@ -21,6 +21,7 @@
 
 #include "gtkcssstaticstyleprivate.h"
 #include "gtkcssanimatedstyleprivate.h"
+#include "gtkcssselectorprivate.h"
 #include "gtkcssstylepropertyprivate.h"
 #include "gtkintl.h"
 #include "gtkmarshalers.h"
@@ -128,6 +129,10 @@ static int invalidated_nodes;
 static int created_styles;
 static guint invalidated_nodes_counter;
 static guint created_styles_counter;
+static guint shared_style_hits_counter;
+static guint shared_style_misses_counter;
+static guint bloom_rejections_counter;
+static guint bloom_false_positives_counter;
 
 static void
 gtk_css_node_set_invalid (GtkCssNode *node,
@@ -631,6 +636,10 @@ gtk_css_node_class_init (GtkCssNodeClass *klass)
     {
       invalidated_nodes_counter = gdk_profiler_define_int_counter ("invalidated-nodes", "CSS Node Invalidations");
       created_styles_counter = gdk_profiler_define_int_counter ("created-styles", "CSS Style Creations");
+      shared_style_hits_counter = gdk_profiler_define_int_counter ("shared-style-hits", "CSS Shared Style Cache Hits");
+      shared_style_misses_counter = gdk_profiler_define_int_counter ("shared-style-misses", "CSS Shared Style Cache Misses");
+      bloom_rejections_counter = gdk_profiler_define_int_counter ("bloom-rejections", "CSS Selector Bloom Filter Rejections");
+      bloom_false_positives_counter = gdk_profiler_define_int_counter ("bloom-false-positives", "CSS Selector Bloom Filter False Positives");
     }
 }
 
@@ -1213,13 +1222,65 @@ gtk_css_node_get_classes (GtkCssNode *cssnode)
   return result;
 }
 
+/* The styles cached for children were computed for the old classes
+ * of their ancestors, so they all go. Only nodes a selector using the
+ * class on an ancestor may match get restyled though, and a source
+ * change does that without propagating to their children.
+ */
+static void
+gtk_css_node_invalidate_descendants_for_class (GtkCssNode *cssnode,
+                                               GQuark      style_class)
+{
+  GtkCssNode *child;
+
+  g_clear_pointer (&cssnode->cache, gtk_css_node_style_cache_unref);
+
+  for (child = gtk_css_node_get_first_child (cssnode);
+       child;
+       child = gtk_css_node_get_next_sibling (child))
+    {
+      if (gtk_css_selector_class_may_match_other (style_class, child))
+        gtk_css_node_invalidate (child, GTK_CSS_CHANGE_SOURCE);
+
+      gtk_css_node_invalidate_descendants_for_class (child, style_class);
+    }
+}
+
+/* Class changes are radical changes, so invalidating with
+ * GTK_CSS_CHANGE_CLASS restyles the node and everything below it.
+ * Use the selectors' class dependencies to do less where possible.
+ */
+static void
+gtk_css_node_invalidate_class (GtkCssNode *cssnode,
+                               GQuark      style_class)
+{
+  GtkCssChange dependencies;
+
+  dependencies = gtk_css_selector_get_class_dependencies (style_class);
+
+  /* No selector uses the class, so no style can change */
+  if (dependencies == 0)
+    return;
+
+  if (dependencies & ~GTK_CSS_CHANGE_PARENT_CLASS)
+    {
+      gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
+      return;
+    }
+
+  /* The class is only used to match ancestors, so our own style
+   * stays the same and only some of our descendants need a restyle.
+   */
+  gtk_css_node_invalidate_descendants_for_class (cssnode, style_class);
+}
+
 void
 gtk_css_node_add_class (GtkCssNode *cssnode,
                         GQuark      style_class)
 {
   if (gtk_css_node_declaration_add_class (&cssnode->decl, style_class))
     {
-      gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
+      gtk_css_node_invalidate_class (cssnode, style_class);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
 }
@@ -1230,7 +1291,7 @@ gtk_css_node_remove_class (GtkCssNode *cssnode,
 {
   if (gtk_css_node_declaration_remove_class (&cssnode->decl, style_class))
     {
-      gtk_css_node_invalidate (cssnode, GTK_CSS_CHANGE_CLASS);
+      gtk_css_node_invalidate_class (cssnode, style_class);
       g_object_notify_by_pspec (G_OBJECT (cssnode), cssnode_properties[PROP_CLASSES]);
     }
 }
@@ -1376,9 +1437,19 @@ gtk_css_node_validate (GtkCssNode *cssnode)
 
   if (GDK_PROFILER_IS_RUNNING)
     {
+      guint shared_style_hits, shared_style_misses;
+      guint bloom_rejections, bloom_false_positives;
+
+      gtk_css_static_style_get_shared_cache_stats (&shared_style_hits, &shared_style_misses);
+      gtk_css_selector_tree_get_bloom_stats (&bloom_rejections, &bloom_false_positives);
+
       gdk_profiler_end_mark (before,  "css validation", "");
       gdk_profiler_set_int_counter (invalidated_nodes_counter, invalidated_nodes);
       gdk_profiler_set_int_counter (created_styles_counter, created_styles);
+      gdk_profiler_set_int_counter (shared_style_hits_counter, shared_style_hits);
+      gdk_profiler_set_int_counter (shared_style_misses_counter, shared_style_misses);
+      gdk_profiler_set_int_counter (bloom_rejections_counter, bloom_rejections);
+      gdk_profiler_set_int_counter (bloom_false_positives_counter, bloom_false_positives);
       invalidated_nodes = 0;
       created_styles = 0;
     }
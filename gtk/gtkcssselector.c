@@ -24,6 +24,7 @@
 
 #include "gtkcssprovider.h"
 #include "gtkstylecontextprivate.h"
+#include "gdkprofilerprivate.h"
 
 #include <errno.h>
 #if defined(_MSC_VER) && _MSC_VER >= 1500
@@ -1889,7 +1890,43 @@ gtk_css_selector_tree_found_match (const GtkCssSelectorTree  *tree,
     gtk_css_selector_matches_insert_sorted (results, matches[i]);
 }
 
+static guint bloom_rejections;
+static guint bloom_false_positives;
+
+/* Checks the branch starting at @tree against the ancestor hashes
+ * in @filter, before walking any ancestors.
+ */
 static gboolean
+gtk_css_selector_tree_may_match_ancestor (const GtkCssSelectorTree     *tree,
+                                          const GtkCountingBloomFilter *filter)
+{
+  if (tree->selector.class->category != GTK_CSS_SELECTOR_CATEGORY_SIMPLE_RADICAL)
+    return TRUE;
+
+  if (gtk_counting_bloom_filter_may_contain (filter, gtk_css_selector_hash_one (&tree->selector)))
+    return TRUE;
+
+  bloom_rejections++;
+
+  return FALSE;
+}
+
+static void
+gtk_css_selector_tree_check_false_positive (const GtkCssSelectorTree *tree,
+                                            GtkCssNode               *node)
+{
+  for (node = gtk_css_node_get_parent (node);
+       node;
+       node = gtk_css_node_get_parent (node))
+    {
+      if (gtk_css_selector_match_one (&tree->selector, node))
+        return;
+    }
+
+  bloom_false_positives++;
+}
+
+static void
 gtk_css_selector_tree_match (const GtkCssSelectorTree      *tree,
                              const GtkCountingBloomFilter  *filter,
                              gboolean                       match_filter,
@@ -1899,12 +1936,8 @@ gtk_css_selector_tree_match (const GtkCssSelectorTree      *tree,
   const GtkCssSelectorTree *prev;
   GtkCssNode *child;
 
-  if (match_filter && tree->selector.class->category == GTK_CSS_SELECTOR_CATEGORY_SIMPLE_RADICAL &&
-      !gtk_counting_bloom_filter_may_contain (filter, gtk_css_selector_hash_one (&tree->selector)))
-    return FALSE;
-
   if (!gtk_css_selector_match_one (&tree->selector, node))
-    return TRUE;
+    return;
 
   gtk_css_selector_tree_found_match (tree, results);
 
@@ -1915,16 +1948,24 @@ gtk_css_selector_tree_match (const GtkCssSelectorTree      *tree,
        prev != NULL;
        prev = gtk_css_selector_tree_get_sibling (prev))
     {
+      if (match_filter)
+        {
+          if (!gtk_css_selector_tree_may_match_ancestor (prev, filter))
+            continue;
+
+          if (GDK_PROFILER_IS_RUNNING &&
+              tree->selector.class == &GTK_CSS_SELECTOR_DESCENDANT &&
+              prev->selector.class->category == GTK_CSS_SELECTOR_CATEGORY_SIMPLE_RADICAL)
+            gtk_css_selector_tree_check_false_positive (prev, node);
+        }
+
       for (child = gtk_css_selector_iterator (&tree->selector, node, NULL);
            child;
            child = gtk_css_selector_iterator (&tree->selector, node, child))
         {
-          if (!gtk_css_selector_tree_match (prev, filter, match_filter, child, results))
-            break;
+          gtk_css_selector_tree_match (prev, filter, match_filter, child, results);
         }
     }
-
-  return TRUE;
 }
 
 void
@@ -1943,6 +1984,21 @@ _gtk_css_selector_tree_match_all (const GtkCssSelectorTree     *tree,
     }
 }
 
+/* Returns how often the ancestor bloom filter rejected a selector
+ * branch and how often it let one pass although no ancestor matched,
+ * since the last call.
+ */
+void
+gtk_css_selector_tree_get_bloom_stats (guint *rejections,
+                                       guint *false_positives)
+{
+  *rejections = bloom_rejections;
+  *false_positives = bloom_false_positives;
+
+  bloom_rejections = 0;
+  bloom_false_positives = 0;
+}
+
 gboolean
 _gtk_css_selector_tree_is_empty (const GtkCssSelectorTree *tree)
 {
@@ -2230,6 +2286,168 @@ _gtk_css_selector_tree_builder_free  (GtkCssSelectorTreeBuilder *builder)
   g_free (builder);
 }
 
+/* Maps every class used in a selector to the GtkCssChange that says
+ * where in the selector it appears, relative to the node the selector
+ * matches: the node itself, its siblings or its ancestors. This lets
+ * nodes skip restyling for class changes no selector cares about.
+ * It is shared by all providers and only ever grows, so it errs on
+ * the safe side when providers go away.
+ *
+ * For classes used on other nodes than the matched one, it also keeps
+ * what the matched node must look like, by its name or else its first
+ * class, so that a class change on an ancestor only needs to restyle
+ * the descendants that could match.
+ */
+typedef struct _GtkCssClassDependencies GtkCssClassDependencies;
+
+struct _GtkCssClassDependencies
+{
+  GtkCssChange change;
+  guint any_subject : 1;  /* a selector matches nodes of any name or class */
+  GHashTable *subject_names;
+  GHashTable *subject_classes;
+};
+
+static GHashTable *class_dependencies;
+
+static void
+gtk_css_class_dependencies_free (gpointer data)
+{
+  GtkCssClassDependencies *dependencies = data;
+
+  g_clear_pointer (&dependencies->subject_names, g_hash_table_unref);
+  g_clear_pointer (&dependencies->subject_classes, g_hash_table_unref);
+  g_free (dependencies);
+}
+
+static void
+gtk_css_class_dependencies_add_subject (GtkCssClassDependencies *dependencies,
+                                        GQuark                   subject_name,
+                                        GQuark                   subject_class)
+{
+  if (subject_name)
+    {
+      if (dependencies->subject_names == NULL)
+        dependencies->subject_names = g_hash_table_new (NULL, NULL);
+      g_hash_table_add (dependencies->subject_names, GUINT_TO_POINTER (subject_name));
+    }
+  else if (subject_class)
+    {
+      if (dependencies->subject_classes == NULL)
+        dependencies->subject_classes = g_hash_table_new (NULL, NULL);
+      g_hash_table_add (dependencies->subject_classes, GUINT_TO_POINTER (subject_class));
+    }
+  else
+    {
+      dependencies->any_subject = TRUE;
+    }
+}
+
+static void
+gtk_css_selector_add_class_dependencies (const GtkCssSelector *selector)
+{
+  GtkCssChange relation = GTK_CSS_CHANGE_CLASS;
+  const GtkCssSelector *simple;
+  GQuark subject_name = 0, subject_class = 0;
+
+  if (class_dependencies == NULL)
+    class_dependencies = g_hash_table_new_full (NULL, NULL, NULL, gtk_css_class_dependencies_free);
+
+  for (simple = selector;
+       simple && gtk_css_selector_is_simple (simple);
+       simple = gtk_css_selector_previous (simple))
+    {
+      if (simple->class == &GTK_CSS_SELECTOR_NAME)
+        subject_name = simple->name.name;
+      else if (simple->class == &GTK_CSS_SELECTOR_CLASS && subject_class == 0)
+        subject_class = simple->style_class.style_class;
+    }
+
+  for (; selector; selector = gtk_css_selector_previous (selector))
+    {
+      if (!gtk_css_selector_is_simple (selector))
+        {
+          relation = selector->class->get_change (selector, relation);
+        }
+      else if (selector->class == &GTK_CSS_SELECTOR_CLASS ||
+               selector->class == &GTK_CSS_SELECTOR_NOT_CLASS)
+        {
+          gpointer key = GUINT_TO_POINTER (selector->style_class.style_class);
+          GtkCssClassDependencies *dependencies;
+
+          dependencies = g_hash_table_lookup (class_dependencies, key);
+          if (dependencies == NULL)
+            {
+              dependencies = g_new0 (GtkCssClassDependencies, 1);
+              g_hash_table_insert (class_dependencies, key, dependencies);
+            }
+
+          dependencies->change |= relation;
+          if (relation != GTK_CSS_CHANGE_CLASS)
+            gtk_css_class_dependencies_add_subject (dependencies, subject_name, subject_class);
+        }
+    }
+}
+
+/* Returns the union of GTK_CSS_CHANGE_CLASS, GTK_CSS_CHANGE_SIBLING_CLASS,
+ * GTK_CSS_CHANGE_PARENT_CLASS and GTK_CSS_CHANGE_PARENT_SIBLING_CLASS for
+ * all places a selector uses @style_class in, or 0 if no selector uses it.
+ */
+GtkCssChange
+gtk_css_selector_get_class_dependencies (GQuark style_class)
+{
+  GtkCssClassDependencies *dependencies;
+
+  if (class_dependencies == NULL)
+    return 0;
+
+  dependencies = g_hash_table_lookup (class_dependencies, GUINT_TO_POINTER (style_class));
+  if (dependencies == NULL)
+    return 0;
+
+  return dependencies->change;
+}
+
+/* Returns whether a selector that uses @style_class on another node,
+ * like an ancestor, may match @node. If not, adding or removing
+ * @style_class on other nodes doesn't change the style of @node.
+ */
+gboolean
+gtk_css_selector_class_may_match_other (GQuark      style_class,
+                                        GtkCssNode *node)
+{
+  GtkCssClassDependencies *dependencies;
+  const GQuark *classes;
+  guint i, n_classes;
+
+  if (class_dependencies == NULL)
+    return FALSE;
+
+  dependencies = g_hash_table_lookup (class_dependencies, GUINT_TO_POINTER (style_class));
+  if (dependencies == NULL)
+    return FALSE;
+
+  if (dependencies->any_subject)
+    return TRUE;
+
+  if (dependencies->subject_names &&
+      g_hash_table_contains (dependencies->subject_names,
+                             GUINT_TO_POINTER (gtk_css_node_get_name (node))))
+    return TRUE;
+
+  if (dependencies->subject_classes == NULL)
+    return FALSE;
+
+  classes = gtk_css_node_declaration_get_classes (gtk_css_node_get_declaration (node), &n_classes);
+  for (i = 0; i < n_classes; i++)
+    {
+      if (g_hash_table_contains (dependencies->subject_classes, GUINT_TO_POINTER (classes[i])))
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
 void
 _gtk_css_selector_tree_builder_add (GtkCssSelectorTreeBuilder *builder,
 				    GtkCssSelector            *selectors,
@@ -2243,6 +2461,8 @@ _gtk_css_selector_tree_builder_add (GtkCssSelectorTreeBuilder *builder,
   info->match = match;
   info->current_selector = selectors;
   info->selector_match = selector_match;
+
+  gtk_css_selector_add_class_dependencies (selectors);
 }
 
 /* Convert all offsets to node-relative */
@@ -60,6 +60,11 @@ GtkCssChange gtk_css_selector_tree_get_change_all    (const GtkCssSelectorTree *
 void         _gtk_css_selector_tree_match_print      (const GtkCssSelectorTree *tree,
 						      GString                  *str);
 gboolean     _gtk_css_selector_tree_is_empty         (const GtkCssSelectorTree *tree) G_GNUC_CONST;
+void         gtk_css_selector_tree_get_bloom_stats   (guint                    *rejections,
+                                                      guint                    *false_positives);
+GtkCssChange gtk_css_selector_get_class_dependencies (GQuark                   style_class);
+gboolean     gtk_css_selector_class_may_match_other  (GQuark                   style_class,
+                                                      GtkCssNode              *node);
 
 
 
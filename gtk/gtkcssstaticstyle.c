@@ -38,6 +38,7 @@
 #include "gtkstylepropertyprivate.h"
 #include "gtkstyleproviderprivate.h"
 #include "gtkcssdimensionvalueprivate.h"
+#include "gtkdebug.h"
 
 static void gtk_css_static_style_compute_value (GtkCssStaticStyle *style,
                                                 GtkStyleProvider  *provider,
@@ -987,6 +988,172 @@ gtk_css_lookup_resolve (GtkCssLookup      *lookup,
     gtk_css_other_values_new_compute (sstyle, provider, parent_style, lookup);
 }
 
+/* Styles computed from the same matched declarations, for the same
+ * provider and parent style, are the same no matter which node they
+ * are for. So unlike the per-parent caches in GtkCssNode, this cache
+ * is shared by all nodes, for example all rows in different lists.
+ *
+ * It holds references to everything in its keys, so that their
+ * addresses can't be reused, and it is cleared when any style provider
+ * changes.
+ */
+#define GTK_CSS_SHARED_STYLE_CACHE_SIZE 4096
+
+typedef struct {
+  guint id;
+  GtkCssSection *section;
+  GtkCssValue *value;
+} SharedStyleValue;
+
+typedef struct {
+  GtkStyleProvider *provider;
+  GtkCssStyle *parent_style;
+  GtkCssChange change;
+  guint hash;
+  guint n_values;
+  SharedStyleValue values[];
+} SharedStyleKey;
+
+static GHashTable *shared_styles;
+static guint shared_style_hits;
+static guint shared_style_misses;
+
+static SharedStyleKey *
+shared_style_key_new (GtkStyleProvider   *provider,
+                      GtkCssStyle        *parent_style,
+                      GtkCssChange        change,
+                      const GtkCssLookup *lookup)
+{
+  SharedStyleKey *key;
+  guint i, n, hash;
+
+  key = g_malloc (sizeof (SharedStyleKey) + GTK_CSS_PROPERTY_N_PROPERTIES * sizeof (SharedStyleValue));
+  key->provider = provider;
+  key->parent_style = parent_style;
+  key->change = change;
+
+  hash = g_direct_hash (provider) ^ g_direct_hash (parent_style) ^ (guint) change ^ (guint) (change >> 32);
+
+  n = 0;
+  for (i = 0; i < GTK_CSS_PROPERTY_N_PROPERTIES; i++)
+    {
+      if (lookup->values[i].value == NULL)
+        continue;
+
+      key->values[n].id = i;
+      key->values[n].section = lookup->values[i].section;
+      key->values[n].value = lookup->values[i].value;
+      hash = hash * 31 + (i ^ g_direct_hash (lookup->values[i].value) ^ g_direct_hash (lookup->values[i].section));
+      n++;
+    }
+
+  key->n_values = n;
+  key->hash = hash;
+
+  return key;
+}
+
+static void
+shared_style_key_ref_contents (SharedStyleKey *key)
+{
+  guint i;
+
+  g_object_ref (key->provider);
+  if (key->parent_style)
+    g_object_ref (key->parent_style);
+
+  for (i = 0; i < key->n_values; i++)
+    {
+      gtk_css_value_ref (key->values[i].value);
+      if (key->values[i].section)
+        gtk_css_section_ref (key->values[i].section);
+    }
+}
+
+static void
+shared_style_key_free (gpointer data)
+{
+  SharedStyleKey *key = data;
+  guint i;
+
+  g_object_unref (key->provider);
+  if (key->parent_style)
+    g_object_unref (key->parent_style);
+
+  for (i = 0; i < key->n_values; i++)
+    {
+      gtk_css_value_unref (key->values[i].value);
+      if (key->values[i].section)
+        gtk_css_section_unref (key->values[i].section);
+    }
+
+  g_free (key);
+}
+
+static guint
+shared_style_key_hash (gconstpointer data)
+{
+  const SharedStyleKey *key = data;
+
+  return key->hash;
+}
+
+static gboolean
+shared_style_key_equal (gconstpointer data1,
+                        gconstpointer data2)
+{
+  const SharedStyleKey *key1 = data1;
+  const SharedStyleKey *key2 = data2;
+  guint i;
+
+  if (key1->hash != key2->hash ||
+      key1->provider != key2->provider ||
+      key1->parent_style != key2->parent_style ||
+      key1->change != key2->change ||
+      key1->n_values != key2->n_values)
+    return FALSE;
+
+  for (i = 0; i < key1->n_values; i++)
+    {
+      if (key1->values[i].id != key2->values[i].id ||
+          key1->values[i].value != key2->values[i].value ||
+          key1->values[i].section != key2->values[i].section)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+may_use_shared_cache (void)
+{
+  /* GTK_DEBUG=no-css-cache disables this cache, too */
+#ifdef G_ENABLE_DEBUG
+  if (GTK_DEBUG_CHECK (NO_CSS_CACHE))
+    return FALSE;
+#endif
+
+  return TRUE;
+}
+
+void
+gtk_css_static_style_clear_shared_cache (void)
+{
+  if (shared_styles)
+    g_hash_table_remove_all (shared_styles);
+}
+
+void
+gtk_css_static_style_get_shared_cache_stats (guint *hits,
+                                             guint *misses)
+{
+  *hits = shared_style_hits;
+  *misses = shared_style_misses;
+
+  shared_style_hits = 0;
+  shared_style_misses = 0;
+}
+
 GtkCssStyle *
 gtk_css_static_style_new_compute (GtkStyleProvider             *provider,
                                   const GtkCountingBloomFilter *filter,
@@ -996,6 +1163,8 @@ gtk_css_static_style_new_compute (GtkStyleProvider             *provider,
   GtkCssStaticStyle *result;
   GtkCssLookup lookup;
   GtkCssNode *parent;
+  GtkCssStyle *parent_style;
+  SharedStyleKey *key = NULL;
 
   _gtk_css_lookup_init (&lookup);
 
@@ -1006,22 +1175,58 @@ gtk_css_static_style_new_compute (GtkStyleProvider             *provider,
                                &lookup,
                                change == 0 ? &change : NULL);
 
-  result = g_object_new (GTK_TYPE_CSS_STATIC_STYLE, NULL);
-
-  result->change = change;
-
   if (node)
     parent = gtk_css_node_get_parent (node);
   else
     parent = NULL;
 
+  parent_style = parent ? gtk_css_node_get_style (parent) : NULL;
+
+  if (may_use_shared_cache ())
+    {
+      key = shared_style_key_new (provider, parent_style, change, &lookup);
+
+      if (shared_styles)
+        {
+          result = g_hash_table_lookup (shared_styles, key);
+          if (result)
+            {
+              shared_style_hits++;
+              g_free (key);
+              _gtk_css_lookup_destroy (&lookup);
+              return g_object_ref (GTK_CSS_STYLE (result));
+            }
+        }
+
+      shared_style_misses++;
+    }
+
+  result = g_object_new (GTK_TYPE_CSS_STATIC_STYLE, NULL);
+
+  result->change = change;
+
   gtk_css_lookup_resolve (&lookup,
                           provider,
                           result,
-                          parent ? gtk_css_node_get_style (parent) : NULL);
+                          parent_style);
 
   _gtk_css_lookup_destroy (&lookup);
 
+  if (key)
+    {
+      if (shared_styles == NULL)
+        shared_styles = g_hash_table_new_full (shared_style_key_hash,
+                                               shared_style_key_equal,
+                                               shared_style_key_free,
+                                               g_object_unref);
+      else if (g_hash_table_size (shared_styles) >= GTK_CSS_SHARED_STYLE_CACHE_SIZE)
+        g_hash_table_remove_all (shared_styles);
+
+      key = g_realloc (key, sizeof (SharedStyleKey) + key->n_values * sizeof (SharedStyleValue));
+      shared_style_key_ref_contents (key);
+      g_hash_table_insert (shared_styles, key, g_object_ref (result));
+    }
+
   return GTK_CSS_STYLE (result);
 }
 
@@ -59,6 +59,11 @@ GtkCssStyle *           gtk_css_static_style_new_compute        (GtkStyleProvide
                                                                  GtkCssChange                    change);
 GtkCssChange            gtk_css_static_style_get_change         (GtkCssStaticStyle              *style);
 
+void                    gtk_css_static_style_clear_shared_cache (void);
+void                    gtk_css_static_style_get_shared_cache_stats
+                                                                (guint                          *hits,
+                                                                 guint                          *misses);
+
 G_END_DECLS
 
 #endif /* __GTK_CSS_STATIC_STYLE_PRIVATE_H__ */
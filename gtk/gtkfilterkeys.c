@@ -0,0 +1,116 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkfilterkeysprivate.h"
+
+/*<private>
+ * SECTION:gtkfilterkeys
+ *
+ * #GtkFilterKeys are the filtering equivalent of #GtkSortKeys.
+ *
+ * A filter model that stores the keys for all its items can
+ * rerun a filter without looking at the items again, as long as
+ * the new keys are compatible with the old ones. This makes it
+ * possible to avoid the expensive parts of filtering - like
+ * evaluating expressions and preparing strings - when only the
+ * search term changes.
+ */
+
+GtkFilterKeys *
+gtk_filter_keys_alloc (const GtkFilterKeysClass *klass,
+                       gsize                     size,
+                       gsize                     key_size,
+                       gsize                     key_align)
+{
+  GtkFilterKeys *self;
+
+  g_return_val_if_fail (key_align > 0, NULL);
+
+  self = g_slice_alloc0 (size);
+
+  self->klass = klass;
+  self->ref_count = 1;
+
+  self->key_size = key_size;
+  self->key_align = key_align;
+
+  return self;
+}
+
+GtkFilterKeys *
+gtk_filter_keys_ref (GtkFilterKeys *self)
+{
+  self->ref_count += 1;
+
+  return self;
+}
+
+void
+gtk_filter_keys_unref (GtkFilterKeys *self)
+{
+  self->ref_count -= 1;
+  if (self->ref_count > 0)
+    return;
+
+  self->klass->free (self);
+}
+
+gsize
+gtk_filter_keys_get_key_size (GtkFilterKeys *self)
+{
+  return self->key_size;
+}
+
+gsize
+gtk_filter_keys_get_key_align (GtkFilterKeys *self)
+{
+  return self->key_align;
+}
+
+gboolean
+gtk_filter_keys_is_compatible (GtkFilterKeys *self,
+                               GtkFilterKeys *other)
+{
+  if (self == other)
+    return TRUE;
+
+  return self->klass->is_compatible (self, other);
+}
+
+gboolean
+gtk_filter_keys_needs_clear_key (GtkFilterKeys *self)
+{
+  return self->klass->clear_key != NULL;
+}
+
+/*<private>
+ * gtk_filter_keys_is_thread_safe:
+ * @self: a #GtkFilterKeys
+ *
+ * Checks if keys created with @self can be matched from a
+ * different thread than the one they were created in.
+ *
+ * Filter models use this to match keys of large models on
+ * multiple threads in parallel.
+ *
+ * Returns: %TRUE if the match function is thread-safe
+ **/
+gboolean
+gtk_filter_keys_is_thread_safe (GtkFilterKeys *self)
+{
+  return self->thread_safe;
+}
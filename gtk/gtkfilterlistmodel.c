@@ -22,7 +22,9 @@
 #include "gtkfilterlistmodel.h"
 
 #include "gtkbitset.h"
+#include "gtkfilterprivate.h"
 #include "gtkintl.h"
+#include "gtkprefetchableprivate.h"
 #include "gtkprivate.h"
 
 /**
@@ -39,8 +41,19 @@
  * The model can be set up to do incremental searching, so that
  * filtering long lists doesn't block the UI. See
  * gtk_filter_list_model_set_incremental() for details.
+ *
+ * When not filtering incrementally, large models are filtered on
+ * multiple threads if the filter supports it. This is the case for
+ * #GtkStringFilter and #GtkBoolFilter.
  */
 
+/* The minimum number of items that a single thread gets to filter
+ *
+ * Below this number, the overhead of handing the items to a thread
+ * is larger than the time spent filtering.
+ */
+#define GTK_FILTER_PARALLEL_MIN_CHUNK (16 * 1024)
+
 enum {
   PROP_0,
   PROP_FILTER,
@@ -62,6 +75,11 @@ struct _GtkFilterListModel
   GtkBitset *matches; /* NULL if strictness != GTK_FILTER_MATCH_SOME */
   GtkBitset *pending; /* not yet filtered items or NULL if all filtered */
   guint pending_cb; /* idle callback handle */
+
+  GtkFilterKeys *filter_keys; /* NULL if the filter doesn't provide keys */
+  gsize key_size;
+  gpointer keys; /* one key per item of the model */
+  GtkBitset *missing_keys; /* keys that haven't been created yet */
 };
 
 struct _GtkFilterListModelClass
@@ -136,8 +154,165 @@ gtk_filter_list_model_model_init (GListModelInterface *iface)
   iface->get_item = gtk_filter_list_model_get_item;
 }
 
+static void
+gtk_filter_list_model_prefetch (GtkPrefetchable *prefetchable,
+                                guint            position,
+                                guint            n_items)
+{
+  GtkFilterListModel *self = GTK_FILTER_LIST_MODEL (prefetchable);
+  guint first, last;
+
+  switch (self->strictness)
+    {
+    case GTK_FILTER_MATCH_NONE:
+      return;
+
+    case GTK_FILTER_MATCH_ALL:
+      gtk_prefetchable_forward (self->model, position, n_items);
+      return;
+
+    case GTK_FILTER_MATCH_SOME:
+      if (position >= gtk_bitset_get_size (self->matches))
+        return;
+      n_items = MIN (n_items, gtk_bitset_get_size (self->matches) - position);
+      first = gtk_bitset_get_nth (self->matches, position);
+      last = gtk_bitset_get_nth (self->matches, position + n_items - 1);
+      gtk_prefetchable_forward (self->model, first, last - first + 1);
+      return;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static void
+gtk_filter_list_model_prefetchable_init (GtkPrefetchableInterface *iface)
+{
+  iface->prefetch = gtk_filter_list_model_prefetch;
+}
+
 G_DEFINE_TYPE_WITH_CODE (GtkFilterListModel, gtk_filter_list_model, G_TYPE_OBJECT,
-                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_filter_list_model_model_init))
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_filter_list_model_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_PREFETCHABLE, gtk_filter_list_model_prefetchable_init))
+
+static gpointer
+key_from_pos (GtkFilterListModel *self,
+              guint               pos)
+{
+  return (char *) self->keys + self->key_size * pos;
+}
+
+static void
+gtk_filter_list_model_clear_filter_keys (GtkFilterListModel *self,
+                                         guint               position,
+                                         guint               n_items)
+{
+  GtkBitsetIter iter;
+  GtkBitset *clear;
+  guint pos;
+
+  if (n_items == 0 || !gtk_filter_keys_needs_clear_key (self->filter_keys))
+    return;
+
+  clear = gtk_bitset_new_range (position, n_items);
+  gtk_bitset_subtract (clear, self->missing_keys);
+
+  for (gtk_bitset_iter_init_first (&iter, clear, &pos);
+       gtk_bitset_iter_is_valid (&iter);
+       gtk_bitset_iter_next (&iter, &pos))
+    {
+      gtk_filter_keys_clear_key (self->filter_keys, key_from_pos (self, pos));
+    }
+
+  gtk_bitset_unref (clear);
+}
+
+static void
+gtk_filter_list_model_clear_keys (GtkFilterListModel *self)
+{
+  if (self->filter_keys == NULL)
+    return;
+
+  gtk_filter_list_model_clear_filter_keys (self, 0, g_list_model_get_n_items (self->model));
+
+  g_clear_pointer (&self->missing_keys, gtk_bitset_unref);
+  g_clear_pointer (&self->keys, g_free);
+  g_clear_pointer (&self->filter_keys, gtk_filter_keys_unref);
+  self->key_size = 0;
+}
+
+/* Makes sure the stored keys match the filter's current keys.
+ * Keys are kept if the new keys are compatible, so a filter that
+ * only changes its search term doesn't need to look at items again.
+ */
+static void
+gtk_filter_list_model_update_keys (GtkFilterListModel *self)
+{
+  GtkFilterKeys *new_keys;
+  guint n_items;
+
+  if (self->model && self->filter)
+    new_keys = gtk_filter_get_keys (self->filter);
+  else
+    new_keys = NULL;
+
+  if (new_keys == NULL)
+    {
+      gtk_filter_list_model_clear_keys (self);
+      return;
+    }
+
+  if (self->filter_keys && gtk_filter_keys_is_compatible (new_keys, self->filter_keys))
+    {
+      gtk_filter_keys_unref (self->filter_keys);
+      self->filter_keys = new_keys;
+      return;
+    }
+
+  gtk_filter_list_model_clear_keys (self);
+
+  n_items = g_list_model_get_n_items (self->model);
+  self->filter_keys = new_keys;
+  self->key_size = gtk_filter_keys_get_key_size (new_keys);
+  self->keys = g_malloc_n (n_items, self->key_size);
+  self->missing_keys = gtk_bitset_new_range (0, n_items);
+}
+
+/* Like gtk_bitset_splice(), but for the keys array */
+static void
+gtk_filter_list_model_splice_keys (GtkFilterListModel *self,
+                                   guint               position,
+                                   guint               removed,
+                                   guint               added)
+{
+  guint n_items;
+
+  if (self->filter_keys == NULL)
+    return;
+
+  /* the model has already changed, so compute the old size */
+  n_items = g_list_model_get_n_items (self->model) - added + removed;
+
+  gtk_filter_list_model_clear_filter_keys (self, position, removed);
+
+  if (removed > added)
+    {
+      memmove (key_from_pos (self, position + added),
+               key_from_pos (self, position + removed),
+               self->key_size * (n_items - position - removed));
+      self->keys = g_realloc_n (self->keys, n_items - removed + added, self->key_size);
+    }
+  else if (removed < added)
+    {
+      self->keys = g_realloc_n (self->keys, n_items - removed + added, self->key_size);
+      memmove (key_from_pos (self, position + added),
+               key_from_pos (self, position + removed),
+               self->key_size * (n_items - position - removed));
+    }
+
+  gtk_bitset_splice (self->missing_keys, position, removed, added);
+  gtk_bitset_add_range (self->missing_keys, position, added);
+}
 
 static gboolean
 gtk_filter_list_model_run_filter_on_item (GtkFilterListModel *self,
@@ -149,6 +324,21 @@ gtk_filter_list_model_run_filter_on_item (GtkFilterListModel *self,
   /* all other cases should have beeen optimized away */
   g_assert (self->strictness == GTK_FILTER_MATCH_SOME);
 
+  if (self->filter_keys)
+    {
+      gpointer key = key_from_pos (self, position);
+
+      if (gtk_bitset_contains (self->missing_keys, position))
+        {
+          item = g_list_model_get_item (self->model, position);
+          gtk_filter_keys_init_key (self->filter_keys, item, key);
+          g_object_unref (item);
+          gtk_bitset_remove (self->missing_keys, position);
+        }
+
+      return gtk_filter_keys_match (self->filter_keys, key);
+    }
+
   item = g_list_model_get_item (self->model, position);
   visible = gtk_filter_match (self->filter, item);
   g_object_unref (item);
@@ -156,12 +346,168 @@ gtk_filter_list_model_run_filter_on_item (GtkFilterListModel *self,
   return visible;
 }
 
+typedef struct _GtkFilterListParallel GtkFilterListParallel;
+typedef struct _GtkFilterListChunk GtkFilterListChunk;
+
+struct _GtkFilterListParallel
+{
+  GtkFilterKeys *filter_keys;
+  gpointer keys;
+  gsize key_size;
+
+  GMutex lock;
+  GCond cond;
+  guint n_pending;
+};
+
+struct _GtkFilterListChunk
+{
+  GtkFilterListParallel *parallel;
+  GtkBitset *items; /* items to check */
+  GtkBitset *matches; /* items that matched */
+};
+
+static void
+gtk_filter_list_model_run_filter_chunk (gpointer data,
+                                        gpointer user_data)
+{
+  GtkFilterListChunk *chunk = data;
+  GtkFilterListParallel *parallel = chunk->parallel;
+  GtkBitsetIter iter;
+  guint pos;
+
+  for (gtk_bitset_iter_init_first (&iter, chunk->items, &pos);
+       gtk_bitset_iter_is_valid (&iter);
+       gtk_bitset_iter_next (&iter, &pos))
+    {
+      if (gtk_filter_keys_match (parallel->filter_keys, (char *) parallel->keys + parallel->key_size * pos))
+        gtk_bitset_add (chunk->matches, pos);
+    }
+
+  g_mutex_lock (&parallel->lock);
+  parallel->n_pending--;
+  if (parallel->n_pending == 0)
+    g_cond_signal (&parallel->cond);
+  g_mutex_unlock (&parallel->lock);
+}
+
+static guint
+gtk_filter_list_model_get_n_threads (GtkFilterListModel *self)
+{
+  if (self->pending == NULL ||
+      self->filter_keys == NULL ||
+      !gtk_filter_keys_is_thread_safe (self->filter_keys))
+    return 1;
+
+  return MIN (g_get_num_processors (),
+              gtk_bitset_get_size (self->pending) / GTK_FILTER_PARALLEL_MIN_CHUNK);
+}
+
+/* All filter models share the same threads, so filtering
+ * doesn't need to spawn new ones every time.
+ */
+static GThreadPool *
+gtk_filter_list_model_get_pool (void)
+{
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (gtk_filter_list_model_run_filter_chunk,
+                                    NULL,
+                                    g_get_num_processors (),
+                                    FALSE,
+                                    NULL);
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  return pool;
+}
+
+/* Filters all pending items on @n_threads threads.
+ *
+ * Creating keys needs the items, so this happens here first. Matching
+ * only needs the keys and is split into chunks of equal size that get
+ * matched in parallel. The results are merged into self->matches.
+ */
+static void
+gtk_filter_list_model_run_filter_parallel (GtkFilterListModel *self,
+                                           guint               n_threads)
+{
+  GtkFilterListParallel parallel = { self->filter_keys, NULL, self->key_size, };
+  GtkFilterListChunk *chunks;
+  GtkBitsetIter iter;
+  GtkBitset *missing;
+  GThreadPool *pool;
+  guint i, pos, n_pending;
+
+  missing = gtk_bitset_copy (self->pending);
+  gtk_bitset_intersect (missing, self->missing_keys);
+  for (gtk_bitset_iter_init_first (&iter, missing, &pos);
+       gtk_bitset_iter_is_valid (&iter);
+       gtk_bitset_iter_next (&iter, &pos))
+    {
+      gpointer item = g_list_model_get_item (self->model, pos);
+      gtk_filter_keys_init_key (self->filter_keys, item, key_from_pos (self, pos));
+      g_object_unref (item);
+    }
+  gtk_bitset_subtract (self->missing_keys, missing);
+  gtk_bitset_unref (missing);
+
+  parallel.keys = self->keys;
+  parallel.n_pending = n_threads;
+  g_mutex_init (&parallel.lock);
+  g_cond_init (&parallel.cond);
+
+  n_pending = gtk_bitset_get_size (self->pending);
+  chunks = g_newa (GtkFilterListChunk, n_threads);
+  for (i = 0; i < n_threads; i++)
+    {
+      guint start, end;
+
+      start = gtk_bitset_get_nth (self->pending, (guint64) i * n_pending / n_threads);
+      if (i + 1 < n_threads)
+        end = gtk_bitset_get_nth (self->pending, (guint64) (i + 1) * n_pending / n_threads);
+      else
+        end = gtk_bitset_get_maximum (self->pending) + 1;
+
+      chunks[i].parallel = &parallel;
+      chunks[i].items = gtk_bitset_new_range (start, end - start);
+      gtk_bitset_intersect (chunks[i].items, self->pending);
+      chunks[i].matches = gtk_bitset_new_empty ();
+    }
+
+  pool = gtk_filter_list_model_get_pool ();
+  for (i = 0; i < n_threads; i++)
+    g_thread_pool_push (pool, &chunks[i], NULL);
+
+  g_mutex_lock (&parallel.lock);
+  while (parallel.n_pending > 0)
+    g_cond_wait (&parallel.cond, &parallel.lock);
+  g_mutex_unlock (&parallel.lock);
+
+  g_cond_clear (&parallel.cond);
+  g_mutex_clear (&parallel.lock);
+
+  for (i = 0; i < n_threads; i++)
+    {
+      gtk_bitset_union (self->matches, chunks[i].matches);
+      gtk_bitset_unref (chunks[i].matches);
+      gtk_bitset_unref (chunks[i].items);
+    }
+
+  g_clear_pointer (&self->pending, gtk_bitset_unref);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+}
+
 static void
 gtk_filter_list_model_run_filter (GtkFilterListModel *self,
                                   guint               n_steps)
 {
   GtkBitsetIter iter;
-  guint i, pos;
+  guint i, pos, n_threads;
   gboolean more;
 
   g_return_if_fail (GTK_IS_FILTER_LIST_MODEL (self));
@@ -169,6 +515,16 @@ gtk_filter_list_model_run_filter (GtkFilterListModel *self,
   if (self->pending == NULL)
     return;
 
+  if (n_steps == G_MAXUINT)
+    {
+      n_threads = gtk_filter_list_model_get_n_threads (self);
+      if (n_threads > 1)
+        {
+          gtk_filter_list_model_run_filter_parallel (self, n_threads);
+          return;
+        }
+    }
+
   for (i = 0, more = gtk_bitset_iter_init_first (&iter, self->pending, &pos);
        i < n_steps && more;
        i++, more = gtk_bitset_iter_next (&iter, &pos))
@@ -281,6 +637,8 @@ gtk_filter_list_model_items_changed_cb (GListModel         *model,
 {
   guint filter_removed, filter_added;
 
+  gtk_filter_list_model_splice_keys (self, position, removed, added);
+
   switch (self->strictness)
     {
     case GTK_FILTER_MATCH_NONE:
@@ -387,6 +745,7 @@ gtk_filter_list_model_clear_model (GtkFilterListModel *self)
     return;
 
   gtk_filter_list_model_stop_filtering (self);
+  gtk_filter_list_model_clear_keys (self);
   g_signal_handlers_disconnect_by_func (self->model, gtk_filter_list_model_items_changed_cb, self);
   g_clear_object (&self->model);
   if (self->matches)
@@ -399,6 +758,8 @@ gtk_filter_list_model_refilter (GtkFilterListModel *self,
 {
   GtkFilterMatch new_strictness;
 
+  gtk_filter_list_model_update_keys (self);
+
   if (self->model == NULL)
     new_strictness = GTK_FILTER_MATCH_NONE;
   else if (self->filter == NULL)
@@ -726,6 +1087,7 @@ gtk_filter_list_model_set_model (GtkFilterListModel *self,
     {
       self->model = g_object_ref (model);
       g_signal_connect (model, "items-changed", G_CALLBACK (gtk_filter_list_model_items_changed_cb), self);
+      gtk_filter_list_model_update_keys (self);
       if (removed == 0)
         {
           self->strictness = GTK_FILTER_MATCH_NONE;
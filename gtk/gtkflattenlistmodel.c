@@ -51,6 +51,7 @@ struct _FlattenNode
 {
   GListModel *model;
   GtkFlattenListModel *list;
+  guint n_items; /* cached, so looking up positions doesn't query the models */
 };
 
 struct _FlattenAugment
@@ -98,7 +99,7 @@ gtk_flatten_list_model_get_nth (GtkRbTree *tree,
           position -= aug->n_items;
         }
 
-      model_n_items = g_list_model_get_n_items (node->model);
+      model_n_items = node->n_items;
       if (position < model_n_items)
         break;
       position -= model_n_items;
@@ -141,7 +142,7 @@ gtk_flatten_list_model_get_nth_model (GtkRbTree *tree,
       if (position == 0)
         break;
       position--;
-      before += g_list_model_get_n_items (node->model);
+      before += node->n_items;
 
       node = gtk_rb_tree_node_get_right (node);
     }
@@ -216,6 +217,13 @@ gtk_flatten_list_model_items_changed_cb (GListModel          *model,
   GtkFlattenListModel *self = node->list;
   guint real_position;
 
+  if (removed == 0 && added == 0)
+    return;
+
+  /* Looking up the position below needs the counts of the left
+   * subtrees, so those get recomputed right away.
+   */
+  node->n_items = node->n_items - removed + added;
   gtk_rb_tree_node_mark_dirty (node);
   real_position = position;
 
@@ -238,7 +246,7 @@ gtk_flatten_list_model_items_changed_cb (GListModel          *model,
               FlattenAugment *aug = gtk_rb_tree_get_augment (self->items, left);
               real_position += aug->n_items;
             }
-          real_position += g_list_model_get_n_items (parent->model);
+          real_position += parent->n_items;
         }
     }
 
@@ -264,7 +272,7 @@ gtk_flatten_list_model_augment (GtkRbTree *flatten,
   FlattenNode *node = _node;
   FlattenAugment *aug = _aug;
 
-  aug->n_items = g_list_model_get_n_items (node->model);
+  aug->n_items = node->n_items;
   aug->n_models = 1;
 
   if (left)
@@ -291,16 +299,17 @@ gtk_flatten_list_model_add_items (GtkFlattenListModel *self,
   guint added, i;
 
   added = 0;
-  for (i = 0; i < n; i++)
+  node = gtk_rb_tree_insert_many_before (self->items, after, n);
+  for (i = 0; i < n; i++, node = gtk_rb_tree_node_get_next (node))
     {
-      node = gtk_rb_tree_insert_before (self->items, after);
       node->model = g_list_model_get_item (self->model, position + i);
       g_signal_connect (node->model,
                         "items-changed",
                         G_CALLBACK (gtk_flatten_list_model_items_changed_cb),
                         node);
       node->list = self;
-      added += g_list_model_get_n_items (node->model);
+      node->n_items = g_list_model_get_n_items (node->model);
+      added += node->n_items;
     }
 
   return added;
@@ -362,7 +371,7 @@ gtk_flatten_list_model_model_items_changed_cb (GListModel          *model,
   for (i = 0; i < removed; i++)
     {
       FlattenNode *next = gtk_rb_tree_node_get_next (node);
-      real_removed += g_list_model_get_n_items (node->model);
+      real_removed += node->n_items;
       gtk_rb_tree_remove (self->items, node);
       node = next;
     }
@@ -31,12 +31,20 @@
 #include "gtklistitemwidgetprivate.h"
 #include "gtkmultiselection.h"
 #include "gtkorientable.h"
+#include "gtkprefetchable.h"
 #include "gtkscrollable.h"
 #include "gtksingleselection.h"
 #include "gtksnapshot.h"
 #include "gtktypebuiltins.h"
 #include "gtkwidgetprivate.h"
 
+/* Items that will become visible within this time at the current
+ * scrolling speed are prefetched, but at least one page and no more
+ * than the given number of pages.
+ */
+#define GTK_LIST_BASE_PREFETCH_TIME (G_USEC_PER_SEC / 2)
+#define GTK_LIST_BASE_MAX_PREFETCH_PAGES 4
+
 typedef struct _RubberbandData RubberbandData;
 
 struct _RubberbandData
@@ -79,6 +87,12 @@ struct _GtkListBasePrivate
   guint autoscroll_id;
   double autoscroll_delta_x;
   double autoscroll_delta_y;
+
+  /* last scroll position, to predict the items needed next */
+  int prefetch_value;
+  gint64 prefetch_time;
+  guint prefetch_position;
+  guint prefetch_n_items;
 };
 
 enum
@@ -168,6 +182,66 @@ gtk_list_base_get_adjustment_values (GtkListBase    *self,
     *page_size = ps;
 }
 
+static GtkBitset *gtk_list_base_get_items_in_rect (GtkListBase        *self,
+                                                    const GdkRectangle *rect);
+
+static void
+gtk_list_base_update_prefetch (GtkListBase *self)
+{
+  GtkListBasePrivate *priv = gtk_list_base_get_instance_private (self);
+  GdkRectangle rect;
+  GtkBitset *items;
+  int value, total_size, page_size, delta, ahead;
+  gint64 now, elapsed;
+  guint first, last;
+
+  if (!GTK_IS_PREFETCHABLE (priv->model))
+    return;
+
+  gtk_list_base_get_adjustment_values (self, priv->orientation, &value, &total_size, &page_size);
+  now = g_get_monotonic_time ();
+  delta = value - priv->prefetch_value;
+  elapsed = now - priv->prefetch_time;
+  priv->prefetch_value = value;
+  priv->prefetch_time = now;
+
+  if (delta == 0 || page_size <= 0)
+    return;
+
+  if (elapsed > 0)
+    ahead = MIN ((gint64) ABS (delta) * GTK_LIST_BASE_PREFETCH_TIME / elapsed, G_MAXINT);
+  else
+    ahead = page_size;
+  ahead = CLAMP (ahead, page_size, GTK_LIST_BASE_MAX_PREFETCH_PAGES * page_size);
+
+  /* extend the visible area in the direction we are scrolling */
+  gtk_list_base_get_adjustment_values (self, OPPOSITE_ORIENTATION (priv->orientation), &rect.x, NULL, &rect.width);
+  if (delta > 0)
+    rect.y = value;
+  else
+    rect.y = MAX (0, value - ahead);
+  rect.height = MIN (value + page_size + (delta > 0 ? ahead : 0), total_size) - rect.y;
+  if (rect.width <= 0 || rect.height <= 0)
+    return;
+
+  items = gtk_list_base_get_items_in_rect (self, &rect);
+  if (!gtk_bitset_is_empty (items))
+    {
+      first = gtk_bitset_get_minimum (items);
+      last = gtk_bitset_get_maximum (items);
+      if (first != priv->prefetch_position ||
+          last - first + 1 != priv->prefetch_n_items)
+        {
+          priv->prefetch_position = first;
+          priv->prefetch_n_items = last - first + 1;
+          gtk_prefetchable_prefetch (GTK_PREFETCHABLE (priv->model),
+                                     priv->prefetch_position,
+                                     priv->prefetch_n_items);
+        }
+    }
+  gtk_bitset_unref (items);
+}
+
 static void
 gtk_list_base_adjustment_value_changed_cb (GtkAdjustment *adjustment,
                                            GtkListBase   *self)
@@ -243,6 +317,8 @@ gtk_list_base_adjustment_value_changed_cb (GtkAdjustment *adjustment,
                             align_along, side_along);
   
   gtk_widget_queue_allocate (GTK_WIDGET (self));
+
+  gtk_list_base_update_prefetch (self);
 }
 
 static void
@@ -1107,6 +1183,33 @@ gtk_list_base_add_custom_move_binding (GtkWidgetClass  *widget_class,
                                 "(bbb)", TRUE, TRUE, TRUE);
 }
 
+static void
+gtk_list_base_snapshot (GtkWidget   *widget,
+                        GtkSnapshot *snapshot)
+{
+  graphene_rect_t viewport, bounds;
+  GtkWidget *child;
+
+  viewport = GRAPHENE_RECT_INIT (0, 0,
+                                 gtk_widget_get_width (widget),
+                                 gtk_widget_get_height (widget));
+
+  /* Rows keep their render node while only their position changes,
+   * so when scrolling only rows that become visible need to be drawn.
+   * Rows outside of the visible area are not drawn at all.
+   */
+  for (child = _gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = _gtk_widget_get_next_sibling (child))
+    {
+      if (!gtk_widget_compute_bounds (child, widget, &bounds) ||
+          !graphene_rect_intersection (&viewport, &bounds, NULL))
+        continue;
+
+      gtk_widget_snapshot_child (widget, child, snapshot);
+    }
+}
+
 static void
 gtk_list_base_class_init (GtkListBaseClass *klass)
 {
@@ -1115,6 +1218,7 @@ gtk_list_base_class_init (GtkListBaseClass *klass)
   gpointer iface;
 
   widget_class->focus = gtk_list_base_focus;
+  widget_class->snapshot = gtk_list_base_snapshot;
 
   gobject_class->dispose = gtk_list_base_dispose;
   gobject_class->get_property = gtk_list_base_get_property;
@@ -2120,6 +2224,8 @@ gtk_list_base_set_model (GtkListBase       *self,
     return FALSE;
 
   g_clear_object (&priv->model);
+  priv->prefetch_position = 0;
+  priv->prefetch_n_items = 0;
 
   if (model)
     {
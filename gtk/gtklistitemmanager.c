@@ -24,8 +24,19 @@
 #include "gtklistitemwidgetprivate.h"
 #include "gtkwidgetprivate.h"
 
+#include "gdkprofilerprivate.h"
+
 #define GTK_LIST_VIEW_MAX_LIST_ITEMS 200
 
+/* The maximum number of unused list items we keep around for reuse.
+ *
+ * List items are set up by the factory when they get rooted, which can
+ * be expensive, so instead of destroying list items that aren't needed
+ * anymore, we unparent them without tearing them down and reuse them
+ * the next time we need one.
+ */
+#define GTK_LIST_ITEM_MANAGER_MAX_POOL_SIZE 64
+
 struct _GtkListItemManager
 {
   GObject parent_instance;
@@ -39,6 +50,9 @@ struct _GtkListItemManager
 
   GtkRbTree *items;
   GSList *trackers;
+
+  GQueue pool; /* unparented list items that are still set up, owns a reference */
+  GtkWidget *measure_widget; /* last child while measuring items */
 };
 
 struct _GtkListItemManagerClass
@@ -74,6 +88,11 @@ static void             gtk_list_item_manager_release_list_item (GtkListItemMana
                                                                  GtkWidget              *widget);
 G_DEFINE_TYPE (GtkListItemManager, gtk_list_item_manager, G_TYPE_OBJECT)
 
+static guint pool_hits_counter;
+static guint pool_misses_counter;
+static guint pool_hits;
+static guint pool_misses;
+
 void
 gtk_list_item_manager_augment_node (GtkRbTree *tree,
                                     gpointer   node_augment,
@@ -570,6 +589,14 @@ gtk_list_item_manager_ensure_items (GtkListItemManager *self,
 
   while ((widget = g_queue_pop_head (&released)))
     gtk_list_item_manager_release_list_item (self, NULL, widget);
+
+  if (GDK_PROFILER_IS_RUNNING)
+    {
+      gdk_profiler_set_int_counter (pool_hits_counter, pool_hits);
+      gdk_profiler_set_int_counter (pool_misses_counter, pool_misses);
+      pool_hits = 0;
+      pool_misses = 0;
+    }
 }
 
 static void
@@ -579,12 +606,14 @@ gtk_list_item_manager_model_items_changed_cb (GListModel         *model,
                                               guint               added,
                                               GtkListItemManager *self)
 {
+  GHashTableIter iter;
   GHashTable *change;
+  GtkWidget *widget;
   GSList *l;
   guint n_items;
 
   n_items = g_list_model_get_n_items (G_LIST_MODEL (self->model));
-  change = g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL, (GDestroyNotify )gtk_widget_unparent);
+  change = g_hash_table_new (g_direct_hash, g_direct_equal);
 
   gtk_list_item_manager_remove_items (self, change, position, removed);
   gtk_list_item_manager_add_items (self, position, added);
@@ -728,6 +757,10 @@ gtk_list_item_manager_model_items_changed_cb (GListModel         *model,
       tracker->widget = GTK_LIST_ITEM_WIDGET (item->widget);
     }
 
+  /* release the items that were removed and not reused */
+  g_hash_table_iter_init (&iter, change);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &widget))
+    gtk_list_item_manager_release_list_item (self, NULL, widget);
   g_hash_table_unref (change);
 
   gtk_widget_queue_resize (self->widget);
@@ -787,12 +820,33 @@ gtk_list_item_manager_clear_model (GtkListItemManager *self)
   g_clear_object (&self->model);
 }
 
+/*<private>
+ * gtk_list_item_manager_clear_pool:
+ * @self: a #GtkListItemManager
+ *
+ * Tears down and drops all unused list items that are kept for reuse.
+ * This needs to be called when the pooled items would be set up
+ * differently now, like when a column view changes its columns.
+ **/
+void
+gtk_list_item_manager_clear_pool (GtkListItemManager *self)
+{
+  GtkWidget *widget;
+
+  while ((widget = g_queue_pop_head (&self->pool)))
+    {
+      gtk_list_item_widget_set_pooled (GTK_LIST_ITEM_WIDGET (widget), FALSE);
+      g_object_unref (widget);
+    }
+}
+
 static void
 gtk_list_item_manager_dispose (GObject *object)
 {
   GtkListItemManager *self = GTK_LIST_ITEM_MANAGER (object);
 
   gtk_list_item_manager_clear_model (self);
+  gtk_list_item_manager_clear_pool (self);
 
   g_clear_object (&self->factory);
 
@@ -807,6 +861,12 @@ gtk_list_item_manager_class_init (GtkListItemManagerClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
   object_class->dispose = gtk_list_item_manager_dispose;
+
+  if (pool_hits_counter == 0)
+    {
+      pool_hits_counter = gdk_profiler_define_int_counter ("list-item-pool-hits", "List items reused from the pool");
+      pool_misses_counter = gdk_profiler_define_int_counter ("list-item-pool-misses", "List items created");
+    }
 }
 
 static void
@@ -829,6 +889,8 @@ gtk_list_item_manager_set_factory (GtkListItemManager *self,
 
   n_items = self->model ? g_list_model_get_n_items (G_LIST_MODEL (self->model)) : 0;
   gtk_list_item_manager_remove_items (self, NULL, 0, n_items);
+  /* pooled items were set up by the old factory */
+  gtk_list_item_manager_clear_pool (self);
 
   g_set_object (&self->factory, factory);
 
@@ -905,6 +967,8 @@ gtk_list_item_manager_get_model (GtkListItemManager *self)
  * Creates a list item widget to use for @position. No widget may
  * yet exist that is used for @position.
  *
+ * If possible, a previously released widget is reused.
+ *
  * When the returned item is no longer needed, the caller is responsible
  * for calling gtk_list_item_manager_release_list_item().  
  * A particular case is when the row at @position is removed. In that case,
@@ -925,9 +989,16 @@ gtk_list_item_manager_acquire_list_item (GtkListItemManager *self,
   g_return_val_if_fail (GTK_IS_LIST_ITEM_MANAGER (self), NULL);
   g_return_val_if_fail (prev_sibling == NULL || GTK_IS_WIDGET (prev_sibling), NULL);
 
-  result = gtk_list_item_widget_new (self->factory,
-                                     self->item_css_name,
-                                     self->item_role);
+  result = g_queue_pop_head (&self->pool);
+  if (result)
+    pool_hits++;
+  else
+    {
+      pool_misses++;
+      result = gtk_list_item_widget_new (self->factory,
+                                         self->item_css_name,
+                                         self->item_role);
+    }
 
   gtk_list_item_widget_set_single_click_activate (GTK_LIST_ITEM_WIDGET (result), self->single_click_activate);
 
@@ -937,6 +1008,13 @@ gtk_list_item_manager_acquire_list_item (GtkListItemManager *self,
   g_object_unref (item);
   gtk_widget_insert_after (result, self->widget, prev_sibling);
 
+  if (gtk_list_item_widget_get_pooled (GTK_LIST_ITEM_WIDGET (result)))
+    {
+      /* the pool's reference, the widget is owned by its parent now */
+      gtk_list_item_widget_set_pooled (GTK_LIST_ITEM_WIDGET (result), FALSE);
+      g_object_unref (result);
+    }
+
   return GTK_WIDGET (result);
 }
 
@@ -1077,9 +1155,110 @@ gtk_list_item_manager_release_list_item (GtkListItemManager *self,
       return;
     }
 
+  if (self->pool.length < GTK_LIST_ITEM_MANAGER_MAX_POOL_SIZE)
+    {
+      /* Unparent the widget, so it doesn't show up in CSS matching
+       * or accessibility anymore, but keep it set up.
+       */
+      gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (item), GTK_INVALID_LIST_POSITION, NULL, FALSE);
+      gtk_list_item_widget_set_pooled (GTK_LIST_ITEM_WIDGET (item), TRUE);
+      g_queue_push_head (&self->pool, g_object_ref (item));
+      gtk_widget_unparent (item);
+      return;
+    }
+
   gtk_widget_unparent (item);
 }
 
+/*
+ * gtk_list_item_manager_measure_item:
+ * @self: a #GtkListItemManager
+ * @position: the item to measure
+ * @orientation: the orientation to measure
+ * @for_size: Size for the opposite of @orientation or -1
+ * @minimum: (out): location to store the minimum size
+ * @natural: (out): location to store the natural size
+ *
+ * Measures the item at @position with a temporary list item,
+ * without creating a row for it. This is meant to estimate the
+ * size of items that are currently not shown.
+ *
+ * The temporary list item is added as the last child of the widget
+ * and reused for all items measured until
+ * gtk_list_item_manager_finish_measuring() is called, which must
+ * happen before the widget is allocated again.
+ **/
+void
+gtk_list_item_manager_measure_item (GtkListItemManager *self,
+                                    guint               position,
+                                    GtkOrientation      orientation,
+                                    int                 for_size,
+                                    int                *minimum,
+                                    int                *natural)
+{
+  gpointer item;
+
+  g_return_if_fail (GTK_IS_LIST_ITEM_MANAGER (self));
+  g_return_if_fail (self->model != NULL);
+  g_return_if_fail (position < g_list_model_get_n_items (G_LIST_MODEL (self->model)));
+
+  if (self->measure_widget == NULL)
+    {
+      GtkWidget *widget;
+
+      widget = g_queue_pop_head (&self->pool);
+      if (widget == NULL)
+        widget = gtk_list_item_widget_new (self->factory,
+                                           self->item_css_name,
+                                           self->item_role);
+
+      /* After the last child, so no other child changes its position */
+      gtk_widget_insert_before (widget, self->widget, NULL);
+      if (gtk_list_item_widget_get_pooled (GTK_LIST_ITEM_WIDGET (widget)))
+        {
+          gtk_list_item_widget_set_pooled (GTK_LIST_ITEM_WIDGET (widget), FALSE);
+          g_object_unref (widget);
+        }
+      /* set up by now, so this reaches the children, too */
+      gtk_list_item_widget_set_measuring (GTK_LIST_ITEM_WIDGET (widget), TRUE);
+
+      self->measure_widget = widget;
+    }
+
+  item = g_list_model_get_item (G_LIST_MODEL (self->model), position);
+  gtk_list_item_widget_update (GTK_LIST_ITEM_WIDGET (self->measure_widget),
+                               position,
+                               item,
+                               gtk_selection_model_is_selected (self->model, position));
+  g_object_unref (item);
+
+  gtk_widget_measure (self->measure_widget, orientation, for_size,
+                      minimum, natural,
+                      NULL, NULL);
+}
+
+/*
+ * gtk_list_item_manager_finish_measuring:
+ * @self: a #GtkListItemManager
+ *
+ * Removes the temporary list item used by
+ * gtk_list_item_manager_measure_item() again.
+ **/
+void
+gtk_list_item_manager_finish_measuring (GtkListItemManager *self)
+{
+  GtkWidget *widget;
+
+  g_return_if_fail (GTK_IS_LIST_ITEM_MANAGER (self));
+
+  widget = g_steal_pointer (&self->measure_widget);
+  if (widget == NULL)
+    return;
+
+  gtk_list_item_widget_set_measuring (GTK_LIST_ITEM_WIDGET (widget), FALSE);
+  gtk_list_item_manager_release_list_item (self, NULL, widget);
+}
+
 void
 gtk_list_item_manager_set_single_click_activate (GtkListItemManager *self,
                                                  gboolean            single_click_activate)
@@ -87,8 +87,16 @@ GtkListItemFactory *    gtk_list_item_manager_get_factory       (GtkListItemMana
 void                    gtk_list_item_manager_set_model         (GtkListItemManager     *self,
                                                                  GtkSelectionModel      *model);
 GtkSelectionModel *     gtk_list_item_manager_get_model         (GtkListItemManager     *self);
+void                    gtk_list_item_manager_clear_pool        (GtkListItemManager     *self);
 
 guint                   gtk_list_item_manager_get_size          (GtkListItemManager     *self);
+void                    gtk_list_item_manager_measure_item      (GtkListItemManager     *self,
+                                                                 guint                   position,
+                                                                 GtkOrientation          orientation,
+                                                                 int                     for_size,
+                                                                 int                    *minimum,
+                                                                 int                    *natural);
+void                    gtk_list_item_manager_finish_measuring  (GtkListItemManager     *self);
 void                    gtk_list_item_manager_set_single_click_activate
                                                                 (GtkListItemManager     *self,
                                                                  gboolean                single_click_activate);
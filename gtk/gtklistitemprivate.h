@@ -36,6 +36,11 @@ struct _GtkListItem
 
   guint activatable : 1;
   guint selectable : 1;
+
+  /* used by GtkSignalListItemFactory's prepare function */
+  GCancellable *prepare_cancellable;
+  gpointer prepared_data;
+  GDestroyNotify prepared_data_destroy;
 };
 
 GtkListItem *   gtk_list_item_new                               (void);
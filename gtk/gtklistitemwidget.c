@@ -22,6 +22,8 @@
 #include "gtklistitemwidgetprivate.h"
 
 #include "gtkbinlayout.h"
+#include "gtkcolumnviewcellprivate.h"
+#include "gtkcolumnviewcolumnprivate.h"
 #include "gtkeventcontrollerfocus.h"
 #include "gtkeventcontrollermotion.h"
 #include "gtkgestureclick.h"
@@ -44,6 +46,8 @@ struct _GtkListItemWidgetPrivate
   guint position;
   gboolean selected;
   gboolean single_click_activate;
+  gboolean pooled; /* stays set up while unrooted */
+  gboolean measuring; /* only bound to be measured */
 };
 
 enum {
@@ -148,7 +152,8 @@ gtk_list_item_widget_root (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_list_item_widget_parent_class)->root (widget);
 
-  if (priv->factory)
+  /* pooled widgets are still set up */
+  if (priv->factory && priv->list_item == NULL)
     gtk_list_item_factory_setup (priv->factory, self);
 }
 
@@ -160,7 +165,7 @@ gtk_list_item_widget_unroot (GtkWidget *widget)
 
   GTK_WIDGET_CLASS (gtk_list_item_widget_parent_class)->unroot (widget);
 
-  if (priv->list_item)
+  if (priv->list_item && !priv->pooled)
       gtk_list_item_factory_teardown (priv->factory, self);
 }
 
@@ -222,6 +227,27 @@ gtk_list_item_widget_select_action (GtkWidget  *widget,
                               priv->position, modify, extend);
 }
 
+/* Column view rows don't allocate the cells of columns outside the
+ * viewport, so they must not draw them at their old allocation either.
+ */
+static void
+gtk_list_item_widget_snapshot (GtkWidget   *widget,
+                               GtkSnapshot *snapshot)
+{
+  GtkWidget *child;
+
+  for (child = gtk_widget_get_first_child (widget);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      if (GTK_IS_COLUMN_VIEW_CELL (child) &&
+          !gtk_column_view_column_get_in_viewport (gtk_column_view_cell_get_column (GTK_COLUMN_VIEW_CELL (child))))
+        continue;
+
+      gtk_widget_snapshot_child (widget, child, snapshot);
+    }
+}
+
 static void
 gtk_list_item_widget_class_init (GtkListItemWidgetClass *klass)
 {
@@ -234,6 +260,7 @@ gtk_list_item_widget_class_init (GtkListItemWidgetClass *klass)
   widget_class->grab_focus = gtk_list_item_widget_grab_focus;
   widget_class->root = gtk_list_item_widget_root;
   widget_class->unroot = gtk_list_item_widget_unroot;
+  widget_class->snapshot = gtk_list_item_widget_snapshot;
 
   gobject_class->set_property = gtk_list_item_widget_set_property;
   gobject_class->dispose = gtk_list_item_widget_dispose;
@@ -571,6 +598,85 @@ gtk_list_item_widget_default_update (GtkListItemWidget *self,
     }
 }
 
+/*<private>
+ * gtk_list_item_widget_set_pooled:
+ * @self: a #GtkListItemWidget
+ * @pooled: %TRUE to keep @self set up while it has no parent
+ *
+ * Pooled widgets are kept around for reuse after being unparented,
+ * so unlike other widgets they are not torn down when they get
+ * unrooted. When @pooled is set to %FALSE on an unrooted widget,
+ * it gets torn down.
+ *
+ * Children that are list item widgets themselves, like the cells
+ * of a column view row, are pooled along with @self.
+ **/
+void
+gtk_list_item_widget_set_pooled (GtkListItemWidget *self,
+                                 gboolean           pooled)
+{
+  GtkListItemWidgetPrivate *priv = gtk_list_item_widget_get_instance_private (self);
+  GtkWidget *child;
+
+  priv->pooled = pooled;
+
+  for (child = gtk_widget_get_first_child (GTK_WIDGET (self));
+       child;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      if (GTK_IS_LIST_ITEM_WIDGET (child))
+        gtk_list_item_widget_set_pooled (GTK_LIST_ITEM_WIDGET (child), pooled);
+    }
+
+  if (!pooled && priv->list_item && !gtk_widget_get_root (GTK_WIDGET (self)))
+    gtk_list_item_factory_teardown (priv->factory, self);
+}
+
+gboolean
+gtk_list_item_widget_get_pooled (GtkListItemWidget *self)
+{
+  GtkListItemWidgetPrivate *priv = gtk_list_item_widget_get_instance_private (self);
+
+  return priv->pooled;
+}
+
+/*<private>
+ * gtk_list_item_widget_set_measuring:
+ * @self: a #GtkListItemWidget
+ * @measuring: %TRUE if @self is only bound to be measured
+ *
+ * Marks @self as a temporary widget that items are bound to just to
+ * measure them. Factories can skip expensive work for such widgets,
+ * like #GtkSignalListItemFactory does with its prepare function.
+ *
+ * Children that are list item widgets themselves are marked, too.
+ **/
+void
+gtk_list_item_widget_set_measuring (GtkListItemWidget *self,
+                                    gboolean           measuring)
+{
+  GtkListItemWidgetPrivate *priv = gtk_list_item_widget_get_instance_private (self);
+  GtkWidget *child;
+
+  priv->measuring = measuring;
+
+  for (child = gtk_widget_get_first_child (GTK_WIDGET (self));
+       child;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      if (GTK_IS_LIST_ITEM_WIDGET (child))
+        gtk_list_item_widget_set_measuring (GTK_LIST_ITEM_WIDGET (child), measuring);
+    }
+}
+
+gboolean
+gtk_list_item_widget_get_measuring (GtkListItemWidget *self)
+{
+  GtkListItemWidgetPrivate *priv = gtk_list_item_widget_get_instance_private (self);
+
+  return priv->measuring;
+}
+
 void
 gtk_list_item_widget_set_factory (GtkListItemWidget  *self,
                                   GtkListItemFactory *factory)
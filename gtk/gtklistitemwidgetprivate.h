@@ -71,6 +71,12 @@ void                    gtk_list_item_widget_default_update     (GtkListItemWidg
 
 void                    gtk_list_item_widget_set_factory        (GtkListItemWidget      *self,
                                                                  GtkListItemFactory     *factory);
+void                    gtk_list_item_widget_set_pooled         (GtkListItemWidget      *self,
+                                                                 gboolean                pooled);
+gboolean                gtk_list_item_widget_get_pooled         (GtkListItemWidget      *self);
+void                    gtk_list_item_widget_set_measuring      (GtkListItemWidget      *self,
+                                                                 gboolean                measuring);
+gboolean                gtk_list_item_widget_get_measuring      (GtkListItemWidget      *self);
 void                    gtk_list_item_widget_set_single_click_activate
                                                                 (GtkListItemWidget     *self,
                                                                  gboolean               single_click_activate);
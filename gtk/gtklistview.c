@@ -40,6 +40,13 @@
 /* Extra items to keep above + below every tracker */
 #define GTK_LIST_VIEW_EXTRA_ITEMS 2
 
+/* Number of rows that get measured in idle time to improve the
+ * estimated height of rows without a widget.
+ */
+#define GTK_LIST_VIEW_MAX_ROW_SAMPLES 64
+/* Time in microseconds spent on measuring rows per idle run */
+#define GTK_LIST_VIEW_SAMPLE_TIME 1000
+
 /**
  * SECTION:gtklistview
  * @title: GtkListView
@@ -149,6 +156,10 @@ struct _ListRow
 {
   GtkListItemManagerItem parent;
   guint height; /* per row */
+  /* what this row adds to the estimate while it has a widget */
+  guint counted : 1;
+  int counted_min;
+  int counted_nat;
 };
 
 struct _ListRowAugment
@@ -452,23 +463,144 @@ gtk_list_view_move_focus_across (GtkListBase *base,
   return pos;
 }
 
-static int
-compare_ints (gconstpointer first,
-               gconstpointer second)
+static void
+gtk_list_view_reset_row_heights (GtkListView *self,
+                                 int          for_size)
+{
+  ListRow *row;
+
+  self->row_heights_for_size = for_size;
+  self->row_heights_min = 0;
+  self->row_heights_nat = 0;
+  self->n_row_heights = 0;
+  self->n_row_samples = 0;
+  gtk_bitset_remove_all (self->measured_rows);
+
+  for (row = gtk_list_item_manager_get_first (self->item_manager);
+       row != NULL;
+       row = gtk_rb_tree_node_get_next (row))
+    row->counted = FALSE;
+}
+
+static void
+gtk_list_view_add_row_height (GtkListView *self,
+                              guint        pos,
+                              int          min,
+                              int          nat)
 {
-  return *(int *) first - *(int *) second;
+  gtk_bitset_add (self->measured_rows, pos);
+  self->row_heights_min += min;
+  self->row_heights_nat += nat;
+  self->n_row_heights++;
 }
 
+/* Rows change their height when their content changes, like when
+ * a prepared item gets bound, so their share of the estimate has to
+ * follow. The first measurement of a row that was sampled before
+ * replaces the sample as the row's share.
+ */
+static void
+gtk_list_view_count_row_height (GtkListView *self,
+                                ListRow     *row,
+                                guint        pos,
+                                int          min,
+                                int          nat)
+{
+  if (row->counted)
+    {
+      self->row_heights_min -= row->counted_min;
+      self->row_heights_min += min;
+      self->row_heights_nat -= row->counted_nat;
+      self->row_heights_nat += nat;
+    }
+  else if (!gtk_bitset_contains (self->measured_rows, pos))
+    {
+      gtk_list_view_add_row_height (self, pos, min, nat);
+    }
+
+  row->counted = TRUE;
+  row->counted_min = min;
+  row->counted_nat = nat;
+}
+
+/* Unlike the visible rows, the rows without a widget are a sum of
+ * many heights, so we use the mean of all heights we've measured
+ * so far. As it is not limited to the rows currently on screen, it
+ * also does not jump around while scrolling.
+ */
 static guint
-gtk_list_view_get_unknown_row_height (GtkListView *self,
-                                      GArray      *heights)
+gtk_list_view_get_mean_height (guint64 sum,
+                               guint   n)
 {
-  g_return_val_if_fail (heights->len > 0, 0);
+  if (n == 0)
+    return 0;
+
+  return (sum + n / 2) / n;
+}
+
+static guint
+gtk_list_view_get_estimated_row_height (GtkListView         *self,
+                                        GtkScrollablePolicy  scroll_policy)
+{
+  if (scroll_policy == GTK_SCROLL_MINIMUM)
+    return gtk_list_view_get_mean_height (self->row_heights_min, self->n_row_heights);
+  else
+    return gtk_list_view_get_mean_height (self->row_heights_nat, self->n_row_heights);
+}
+
+static gboolean
+gtk_list_view_sample_rows (gpointer data)
+{
+  GtkListView *self = data;
+  GtkOrientation orientation;
+  GtkScrollablePolicy scroll_policy;
+  guint n_items, pos, old_height;
+  gint64 end_time;
+  ListRow *row;
+  int min, nat;
+
+  n_items = gtk_list_base_get_n_items (GTK_LIST_BASE (self));
+  if (n_items == 0)
+    {
+      self->sample_idle = 0;
+      return G_SOURCE_REMOVE;
+    }
+
+  orientation = gtk_list_base_get_orientation (GTK_LIST_BASE (self));
+  scroll_policy = gtk_list_base_get_scroll_policy (GTK_LIST_BASE (self), orientation);
+  old_height = gtk_list_view_get_estimated_row_height (self, scroll_policy);
+  end_time = g_get_monotonic_time () + GTK_LIST_VIEW_SAMPLE_TIME;
+
+  do
+    {
+      pos = g_rand_int_range (self->sample_rand, 0, n_items);
+      row = gtk_list_item_manager_get_nth (self->item_manager, pos, NULL);
+      self->n_row_samples++;
+      /* visible rows are measured anyway */
+      if (row == NULL || row->parent.widget != NULL ||
+          gtk_bitset_contains (self->measured_rows, pos))
+        continue;
+
+      gtk_list_item_manager_measure_item (self->item_manager,
+                                          pos,
+                                          orientation,
+                                          self->row_heights_for_size,
+                                          &min, &nat);
+      gtk_list_view_add_row_height (self, pos, min, nat);
+    }
+  while (self->n_row_samples < GTK_LIST_VIEW_MAX_ROW_SAMPLES &&
+         g_get_monotonic_time () < end_time);
+
+  gtk_list_item_manager_finish_measuring (self->item_manager);
+
+  if (gtk_list_view_get_estimated_row_height (self, scroll_policy) != old_height)
+    gtk_widget_queue_resize (GTK_WIDGET (self));
 
-  /* return the median and hope rows are generally uniform with few outliers */
-  g_array_sort (heights, compare_ints);
+  if (self->n_row_samples < GTK_LIST_VIEW_MAX_ROW_SAMPLES)
+    return G_SOURCE_CONTINUE;
 
-  return g_array_index (heights, int, heights->len / 2);
+  self->sample_idle = 0;
+  return G_SOURCE_REMOVE;
 }
 
 static void
@@ -517,11 +649,9 @@ gtk_list_view_measure_list (GtkWidget      *widget,
   GtkListView *self = GTK_LIST_VIEW (widget);
   ListRow *row;
   int min, nat, child_min, child_nat;
-  GArray *min_heights, *nat_heights;
-  guint n_unknown;
+  guint n_known, n_unknown;
 
-  min_heights = g_array_new (FALSE, FALSE, sizeof (int));
-  nat_heights = g_array_new (FALSE, FALSE, sizeof (int));
+  n_known = 0;
   n_unknown = 0;
   min = 0;
   nat = 0;
@@ -535,10 +665,9 @@ gtk_list_view_measure_list (GtkWidget      *widget,
           gtk_widget_measure (row->parent.widget,
                               orientation, for_size,
                               &child_min, &child_nat, NULL, NULL);
-          g_array_append_val (min_heights, child_min);
-          g_array_append_val (nat_heights, child_nat);
           min += child_min;
           nat += child_nat;
+          n_known++;
         }
       else
         {
@@ -548,11 +677,21 @@ gtk_list_view_measure_list (GtkWidget      *widget,
 
   if (n_unknown)
     {
-      min += n_unknown * gtk_list_view_get_unknown_row_height (self, min_heights);
-      nat += n_unknown * gtk_list_view_get_unknown_row_height (self, nat_heights);
+      /* Use the same estimate as size_allocate(). Before the first
+       * allocation, there are no statistics yet, so use the rows
+       * measured here.
+       */
+      if (self->n_row_heights > 0)
+        {
+          min += n_unknown * gtk_list_view_get_estimated_row_height (self, GTK_SCROLL_MINIMUM);
+          nat += n_unknown * gtk_list_view_get_estimated_row_height (self, GTK_SCROLL_NATURAL);
+        }
+      else
+        {
+          min += n_unknown * gtk_list_view_get_mean_height (min, n_known);
+          nat += n_unknown * gtk_list_view_get_mean_height (nat, n_known);
+        }
     }
-  g_array_free (min_heights, TRUE);
-  g_array_free (nat_heights, TRUE);
 
   *minimum = min;
   *natural = nat;
@@ -583,7 +722,8 @@ gtk_list_view_size_allocate (GtkWidget *widget,
 {
   GtkListView *self = GTK_LIST_VIEW (widget);
   ListRow *row;
-  GArray *heights;
+  gboolean remeasure;
+  guint n_unknown, pos;
   int min, nat, row_height;
   int x, y;
   GtkOrientation orientation, opposite_orientation;
@@ -609,7 +749,9 @@ gtk_list_view_size_allocate (GtkWidget *widget,
     self->list_width = MAX (nat, self->list_width);
 
   /* step 2: determine height of known list items */
-  heights = g_array_new (FALSE, FALSE, sizeof (int));
+  remeasure = self->row_heights_for_size != self->list_width;
+  if (remeasure)
+    gtk_list_view_reset_row_heights (self, self->list_width);
 
   for (row = gtk_list_item_manager_get_first (self->item_manager);
        row != NULL;
@@ -630,12 +772,14 @@ gtk_list_view_size_allocate (GtkWidget *widget,
           row->height = row_height;
           gtk_rb_tree_node_mark_dirty (row);
         }
-      g_array_append_val (heights, row_height);
+      /* count every row once, even if it scrolls out and back in */
+      pos = gtk_list_item_manager_get_item_position (self->item_manager, row);
+      gtk_list_view_count_row_height (self, row, pos, min, nat);
     }
 
   /* step 3: determine height of unknown items */
-  row_height = gtk_list_view_get_unknown_row_height (self, heights);
-  g_array_free (heights, TRUE);
+  row_height = gtk_list_view_get_estimated_row_height (self, scroll_policy);
+  n_unknown = 0;
 
   for (row = gtk_list_item_manager_get_first (self->item_manager);
        row != NULL;
@@ -644,6 +788,9 @@ gtk_list_view_size_allocate (GtkWidget *widget,
       if (row->parent.widget)
         continue;
 
+      /* the row may get a widget for another item later */
+      row->counted = FALSE;
+      n_unknown += row->parent.n_items;
       if (row->height != row_height)
         {
           row->height = row_height;
@@ -651,6 +798,18 @@ gtk_list_view_size_allocate (GtkWidget *widget,
         }
     }
 
+  /* measure some more rows later to improve the estimate */
+  if (n_unknown > 0 &&
+      self->n_row_samples < GTK_LIST_VIEW_MAX_ROW_SAMPLES &&
+      self->sample_idle == 0)
+    {
+      self->sample_idle = g_idle_add_full (G_PRIORITY_LOW,
+                                           gtk_list_view_sample_rows,
+                                           self,
+                                           NULL);
+      g_source_set_name_by_id (self->sample_idle, "[gtk] gtk_list_view_sample_rows");
+    }
+
   /* step 3: update the adjustments */
   gtk_list_base_update_adjustments (GTK_LIST_BASE (self),
                                     self->list_width,
@@ -683,16 +842,46 @@ gtk_list_view_size_allocate (GtkWidget *widget,
   gtk_list_base_allocate_rubberband (GTK_LIST_BASE (self));
 }
 
+static void
+gtk_list_view_model_items_changed_cb (GListModel  *model,
+                                      guint        position,
+                                      guint        removed,
+                                      guint        added,
+                                      GtkListView *self)
+{
+  gtk_bitset_splice (self->measured_rows, position, removed, added);
+}
+
 static void
 gtk_list_view_dispose (GObject *object)
 {
   GtkListView *self = GTK_LIST_VIEW (object);
 
+  if (self->sample_idle)
+    {
+      g_source_remove (self->sample_idle);
+      self->sample_idle = 0;
+    }
+  if (gtk_list_base_get_model (GTK_LIST_BASE (self)))
+    g_signal_handlers_disconnect_by_func (gtk_list_base_get_model (GTK_LIST_BASE (self)),
+                                          gtk_list_view_model_items_changed_cb,
+                                          self);
   self->item_manager = NULL;
 
   G_OBJECT_CLASS (gtk_list_view_parent_class)->dispose (object);
 }
 
+static void
+gtk_list_view_finalize (GObject *object)
+{
+  GtkListView *self = GTK_LIST_VIEW (object);
+
+  gtk_bitset_unref (self->measured_rows);
+  g_rand_free (self->sample_rand);
+
+  G_OBJECT_CLASS (gtk_list_view_parent_class)->finalize (object);
+}
+
 static void
 gtk_list_view_get_property (GObject    *object,
                             guint       property_id,
@@ -806,6 +995,7 @@ gtk_list_view_class_init (GtkListViewClass *klass)
   widget_class->size_allocate = gtk_list_view_size_allocate;
 
   gobject_class->dispose = gtk_list_view_dispose;
+  gobject_class->finalize = gtk_list_view_finalize;
   gobject_class->get_property = gtk_list_view_get_property;
   gobject_class->set_property = gtk_list_view_set_property;
 
@@ -915,6 +1105,9 @@ static void
 gtk_list_view_init (GtkListView *self)
 {
   self->item_manager = gtk_list_base_get_manager (GTK_LIST_BASE (self));
+  self->row_heights_for_size = -1;
+  self->measured_rows = gtk_bitset_new_empty ();
+  self->sample_rand = g_rand_new ();
 
   gtk_list_base_set_anchor_max_widgets (GTK_LIST_BASE (self),
                                         GTK_LIST_VIEW_MAX_LIST_ITEMS,
@@ -988,12 +1181,24 @@ void
 gtk_list_view_set_model (GtkListView       *self,
                          GtkSelectionModel *model)
 {
+  GtkSelectionModel *old_model;
+
   g_return_if_fail (GTK_IS_LIST_VIEW (self));
   g_return_if_fail (model == NULL || GTK_IS_SELECTION_MODEL (model));
 
-  if (!gtk_list_base_set_model (GTK_LIST_BASE (self), model))
+  old_model = gtk_list_base_get_model (GTK_LIST_BASE (self));
+  if (old_model == model)
     return;
 
+  if (old_model)
+    g_signal_handlers_disconnect_by_func (old_model, gtk_list_view_model_items_changed_cb, self);
+
+  gtk_list_base_set_model (GTK_LIST_BASE (self), model);
+
+  gtk_list_view_reset_row_heights (self, -1);
+  if (model)
+    g_signal_connect (model, "items-changed", G_CALLBACK (gtk_list_view_model_items_changed_cb), self);
+
   gtk_accessible_update_property (GTK_ACCESSIBLE (self),
                                   GTK_ACCESSIBLE_PROPERTY_MULTI_SELECTABLE, GTK_IS_MULTI_SELECTION (model),
                                   -1);
@@ -1035,6 +1240,7 @@ gtk_list_view_set_factory (GtkListView        *self,
     return;
 
   gtk_list_item_manager_set_factory (self->item_manager, factory);
+  gtk_list_view_reset_row_heights (self, -1);
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_FACTORY]);
 }
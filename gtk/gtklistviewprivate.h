@@ -33,6 +33,17 @@ struct _GtkListView
   gboolean show_separators;
 
   int list_width;
+
+  /* running statistics of measured row heights, used
+   * to estimate the height of rows without a widget */
+  int row_heights_for_size;
+  guint64 row_heights_min;
+  guint64 row_heights_nat;
+  guint n_row_heights;
+  GtkBitset *measured_rows; /* positions counted in the statistics */
+  guint n_row_samples;
+  guint sample_idle;
+  GRand *sample_rand;
 };
 
 struct _GtkListViewClass
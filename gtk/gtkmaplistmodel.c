@@ -23,6 +23,7 @@
 
 #include "gtkrbtreeprivate.h"
 #include "gtkintl.h"
+#include "gtkprefetchableprivate.h"
 #include "gtkprivate.h"
 
 /**
@@ -208,8 +209,25 @@ gtk_map_list_model_model_init (GListModelInterface *iface)
   iface->get_item = gtk_map_list_model_get_item;
 }
 
+static void
+gtk_map_list_model_prefetch (GtkPrefetchable *prefetchable,
+                             guint            position,
+                             guint            n_items)
+{
+  GtkMapListModel *self = GTK_MAP_LIST_MODEL (prefetchable);
+
+  gtk_prefetchable_forward (self->model, position, n_items);
+}
+
+static void
+gtk_map_list_model_prefetchable_init (GtkPrefetchableInterface *iface)
+{
+  iface->prefetch = gtk_map_list_model_prefetch;
+}
+
 G_DEFINE_TYPE_WITH_CODE (GtkMapListModel, gtk_map_list_model, G_TYPE_OBJECT,
-                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_map_list_model_model_init))
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_map_list_model_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_PREFETCHABLE, gtk_map_list_model_prefetchable_init))
 
 static void
 gtk_map_list_model_items_changed_cb (GListModel      *model,
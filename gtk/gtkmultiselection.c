@@ -23,6 +23,7 @@
 
 #include "gtkbitset.h"
 #include "gtkintl.h"
+#include "gtkprefetchableprivate.h"
 #include "gtkselectionmodel.h"
 
 /**
@@ -33,6 +34,15 @@
  *
  * GtkMultiSelection is an implementation of the #GtkSelectionModel interface
  * that allows selecting multiple elements.
+ *
+ * Selected items that are removed from the model and added back in
+ * the same change, like when the model is resorted, stay selected.
+ * To do that, the selection keeps track of every selected item, which
+ * makes changing the selection take time proportional to the number of
+ * items whose selection changed. For very large lists, this can be
+ * turned off with gtk_multi_selection_set_track_items(), so that
+ * selecting or unselecting ranges of items only takes time
+ * proportional to the number of ranges.
  */
 
 struct _GtkMultiSelection
@@ -42,7 +52,7 @@ struct _GtkMultiSelection
   GListModel *model;
 
   GtkBitset *selected;
-  GHashTable *items; /* item => position */
+  GHashTable *items; /* item => position, or NULL if not tracking items */
 };
 
 struct _GtkMultiSelectionClass
@@ -53,6 +63,7 @@ struct _GtkMultiSelectionClass
 enum {
   PROP_0,
   PROP_MODEL,
+  PROP_TRACK_ITEMS,
 
   N_PROPS,
 };
@@ -127,6 +138,9 @@ gtk_multi_selection_toggle_selection (GtkMultiSelection *self,
 
   gtk_bitset_difference (self->selected, changes);
 
+  if (self->items == NULL)
+    return;
+
   selected = gtk_bitset_copy (changes);
   gtk_bitset_intersect (selected, self->selected);
 
@@ -204,11 +218,29 @@ gtk_multi_selection_selection_model_init (GtkSelectionModelInterface *iface)
   iface->set_selection = gtk_multi_selection_set_selection;
 }
 
+static void
+gtk_multi_selection_prefetch (GtkPrefetchable *prefetchable,
+                              guint            position,
+                              guint            n_items)
+{
+  GtkMultiSelection *self = GTK_MULTI_SELECTION (prefetchable);
+
+  gtk_prefetchable_forward (self->model, position, n_items);
+}
+
+static void
+gtk_multi_selection_prefetchable_init (GtkPrefetchableInterface *iface)
+{
+  iface->prefetch = gtk_multi_selection_prefetch;
+}
+
 G_DEFINE_TYPE_EXTENDED (GtkMultiSelection, gtk_multi_selection, G_TYPE_OBJECT, 0,
                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL,
                                                gtk_multi_selection_list_model_init)
                         G_IMPLEMENT_INTERFACE (GTK_TYPE_SELECTION_MODEL,
-                                               gtk_multi_selection_selection_model_init))
+                                               gtk_multi_selection_selection_model_init)
+                        G_IMPLEMENT_INTERFACE (GTK_TYPE_PREFETCHABLE,
+                                               gtk_multi_selection_prefetchable_init))
 
 static void
 gtk_multi_selection_items_changed_cb (GListModel        *model,
@@ -220,10 +252,24 @@ gtk_multi_selection_items_changed_cb (GListModel        *model,
   GHashTableIter iter;
   gpointer item, pos_pointer;
   GHashTable *pending = NULL;
+  gboolean removed_selected;
   guint i;
 
+  removed_selected = removed > 0 &&
+                     gtk_bitset_get_size_in_range (self->selected, position, position + removed - 1) > 0;
+
   gtk_bitset_splice (self->selected, position, removed, added);
 
+  /* If no selected item was removed and the others didn't move,
+   * the tracked items are all still where they were.
+   */
+  if (self->items == NULL ||
+      (!removed_selected && removed == added))
+    {
+      g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
+      return;
+    }
+
   g_hash_table_iter_init (&iter, self->items);
   while (g_hash_table_iter_next (&iter, &item, &pos_pointer))
     {
@@ -298,6 +344,10 @@ gtk_multi_selection_set_property (GObject      *object,
       gtk_multi_selection_set_model (self, g_value_get_object (value));
       break;
 
+    case PROP_TRACK_ITEMS:
+      gtk_multi_selection_set_track_items (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -318,6 +368,10 @@ gtk_multi_selection_get_property (GObject    *object,
       g_value_set_object (value, self->model);
       break;
 
+    case PROP_TRACK_ITEMS:
+      g_value_set_boolean (value, self->items != NULL);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -358,6 +412,21 @@ gtk_multi_selection_class_init (GtkMultiSelectionClass *klass)
                          G_TYPE_LIST_MODEL,
                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
 
+  /**
+   * GtkMultiSelection:track-items:
+   *
+   * If selected items that are removed and added back in the same
+   * change stay selected
+   *
+   * Since: 4.2
+   */
+  properties[PROP_TRACK_ITEMS] =
+    g_param_spec_boolean ("track-items",
+                          P_("Track items"),
+                          P_("If readded items stay selected"),
+                          TRUE,
+                          G_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY | G_PARAM_STATIC_STRINGS);
+
   g_object_class_install_properties (gobject_class, N_PROPS, properties);
 }
 
@@ -448,9 +517,84 @@ gtk_multi_selection_set_model (GtkMultiSelection *self,
   else
     {
       gtk_bitset_remove_all (self->selected);
-      g_hash_table_remove_all (self->items);
+      if (self->items)
+        g_hash_table_remove_all (self->items);
       g_list_model_items_changed (G_LIST_MODEL (self), 0, n_items_before, 0);
     }
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MODEL]);
 }
+
+/**
+ * gtk_multi_selection_set_track_items:
+ * @self: a #GtkMultiSelection
+ * @track_items: %TRUE to keep track of the selected items
+ *
+ * Sets whether @self keeps track of the selected items, so that
+ * they stay selected when they are removed from the model and added
+ * back in the same change, like when the model is resorted.
+ *
+ * Tracking items makes changing the selection take time proportional
+ * to the number of items whose selection changes, so selecting all
+ * items of a huge model is slow. Without it, it only takes time
+ * proportional to the number of selected ranges, but the selection
+ * follows items only by their position: items that are removed and
+ * added back are unselected, just like new items.
+ *
+ * Items are tracked by default.
+ *
+ * Since: 4.2
+ */
+void
+gtk_multi_selection_set_track_items (GtkMultiSelection *self,
+                                     gboolean           track_items)
+{
+  GtkBitsetIter iter;
+  guint pos;
+  gboolean more;
+
+  g_return_if_fail (GTK_IS_MULTI_SELECTION (self));
+
+  track_items = !!track_items;
+  if (track_items == (self->items != NULL))
+    return;
+
+  if (track_items)
+    {
+      self->items = g_hash_table_new_full (NULL, NULL, g_object_unref, NULL);
+
+      for (more = gtk_bitset_iter_init_first (&iter, self->selected, &pos);
+           more;
+           more = gtk_bitset_iter_next (&iter, &pos))
+        {
+          g_hash_table_insert (self->items,
+                               g_list_model_get_item (G_LIST_MODEL (self), pos),
+                               GUINT_TO_POINTER (pos));
+        }
+    }
+  else
+    {
+      g_clear_pointer (&self->items, g_hash_table_unref);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TRACK_ITEMS]);
+}
+
+/**
+ * gtk_multi_selection_get_track_items:
+ * @self: a #GtkMultiSelection
+ *
+ * Returns whether @self keeps track of the selected items.
+ * See gtk_multi_selection_set_track_items().
+ *
+ * Returns: %TRUE if the selected items are tracked
+ *
+ * Since: 4.2
+ */
+gboolean
+gtk_multi_selection_get_track_items (GtkMultiSelection *self)
+{
+  g_return_val_if_fail (GTK_IS_MULTI_SELECTION (self), TRUE);
+
+  return self->items != NULL;
+}
@@ -38,6 +38,11 @@ GListModel *        gtk_multi_selection_get_model          (GtkMultiSelection
 GDK_AVAILABLE_IN_ALL
 void                gtk_multi_selection_set_model          (GtkMultiSelection    *self,
                                                             GListModel           *model);
+GDK_AVAILABLE_IN_4_2
+void                gtk_multi_selection_set_track_items    (GtkMultiSelection    *self,
+                                                            gboolean              track_items);
+GDK_AVAILABLE_IN_4_2
+gboolean            gtk_multi_selection_get_track_items    (GtkMultiSelection    *self);
 
 G_END_DECLS
 
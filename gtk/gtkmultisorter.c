@@ -19,7 +19,7 @@
 
 #include "config.h"
 
-#include "gtkmultisorter.h"
+#include "gtkmultisorterprivate.h"
 
 #include "gtkbuildable.h"
 #include "gtkintl.h"
@@ -56,6 +56,7 @@ struct _GtkMultiSortKey
 {
   gsize offset;
   GtkSortKeys *keys;
+  gboolean inverted;
 };
 
 struct _GtkMultiSortKeys
@@ -92,29 +93,36 @@ gtk_multi_sort_keys_compare (gconstpointer a,
                                                   ((const char *) a) + self->keys[i].offset,
                                                   ((const char *) b) + self->keys[i].offset);
       if (result != GTK_ORDERING_EQUAL)
-        return result;
+        return self->keys[i].inverted ? - result : result;
     }
 
   return GTK_ORDERING_EQUAL;
 }
 
+static guint gtk_multi_sort_keys_get_parts (GtkSortKeys      *keys,
+                                            GtkMultiSortKey **parts,
+                                            GtkMultiSortKey  *single);
+
 static gboolean
 gtk_multi_sort_keys_is_compatible (GtkSortKeys *keys,
                                    GtkSortKeys *other)
 {
-  GtkMultiSortKeys *self = (GtkMultiSortKeys *) keys;
-  GtkMultiSortKeys *compare = (GtkMultiSortKeys *) other;
-  gsize i;
+  GtkMultiSortKey *parts, *other_parts, single, other_single;
+  guint i, n_parts, n_other_parts;
 
-  if (keys->klass != other->klass)
-    return FALSE;
+  /* @other may not be multi sort keys. A single part has the same
+   * layout as the keys it wraps, so inverting a single sorter
+   * keeps the keys compatible.
+   */
+  n_parts = gtk_multi_sort_keys_get_parts (keys, &parts, &single);
+  n_other_parts = gtk_multi_sort_keys_get_parts (other, &other_parts, &other_single);
 
-  if (self->n_keys != compare->n_keys)
+  if (n_parts != n_other_parts)
     return FALSE;
 
-  for (i = 0; i < self->n_keys; i++)
+  for (i = 0; i < n_parts; i++)
     {
-      if (!gtk_sort_keys_is_compatible (self->keys[i].keys, compare->keys[i].keys))
+      if (!gtk_sort_keys_is_compatible (parts[i].keys, other_parts[i].keys))
         return FALSE;
     }
 
@@ -146,6 +154,32 @@ gtk_multi_sort_keys_clear_key (GtkSortKeys *keys,
     gtk_sort_keys_clear_key (self->keys[i].keys, key + self->keys[i].offset);
 }
 
+/* Sorting by the prefix of the first key is a good start; equal
+ * prefixes still need the full compare to consider the other keys.
+ */
+static guint64
+gtk_multi_sort_keys_get_key_prefix (GtkSortKeys   *keys,
+                                    gconstpointer  key_memory)
+{
+  GtkMultiSortKeys *self = (GtkMultiSortKeys *) keys;
+  guint64 prefix;
+
+  prefix = gtk_sort_keys_get_key_prefix (self->keys[0].keys,
+                                         ((const char *) key_memory) + self->keys[0].offset);
+
+  return self->keys[0].inverted ? G_MAXUINT64 - prefix : prefix;
+}
+
+static gboolean gtk_multi_sort_keys_can_convert (GtkSortKeys *keys,
+                                                 GtkSortKeys *other);
+static void     gtk_multi_sort_keys_convert_key (GtkSortKeys *keys,
+                                                 gpointer     item,
+                                                 gpointer     key_memory,
+                                                 GtkSortKeys *other,
+                                                 gpointer     other_key_memory);
+static gboolean gtk_multi_sort_keys_convert_needs_item (GtkSortKeys *keys,
+                                                        GtkSortKeys *other);
+
 static const GtkSortKeysClass GTK_MULTI_SORT_KEYS_CLASS =
 {
   gtk_multi_sort_keys_free,
@@ -153,29 +187,217 @@ static const GtkSortKeysClass GTK_MULTI_SORT_KEYS_CLASS =
   gtk_multi_sort_keys_is_compatible,
   gtk_multi_sort_keys_init_key,
   gtk_multi_sort_keys_clear_key,
+  gtk_multi_sort_keys_can_convert,
+  gtk_multi_sort_keys_convert_key,
+  NULL,
+  gtk_multi_sort_keys_convert_needs_item,
 };
 
-static GtkSortKeys *
-gtk_multi_sort_keys_new (GtkMultiSorter *self)
+static const GtkSortKeysClass GTK_MULTI_SORT_KEYS_PREFIX_CLASS =
+{
+  gtk_multi_sort_keys_free,
+  gtk_multi_sort_keys_compare,
+  gtk_multi_sort_keys_is_compatible,
+  gtk_multi_sort_keys_init_key,
+  gtk_multi_sort_keys_clear_key,
+  gtk_multi_sort_keys_can_convert,
+  gtk_multi_sort_keys_convert_key,
+  gtk_multi_sort_keys_get_key_prefix,
+  gtk_multi_sort_keys_convert_needs_item,
+};
+
+/* Gets the keys that @keys is made of. Keys that aren't
+ * multi sort keys are treated as a single key.
+ */
+static guint
+gtk_multi_sort_keys_get_parts (GtkSortKeys      *keys,
+                               GtkMultiSortKey **parts,
+                               GtkMultiSortKey  *single)
+{
+  if (keys->klass == &GTK_MULTI_SORT_KEYS_CLASS ||
+      keys->klass == &GTK_MULTI_SORT_KEYS_PREFIX_CLASS)
+    {
+      GtkMultiSortKeys *multi = (GtkMultiSortKeys *) keys;
+
+      *parts = multi->keys;
+      return multi->n_keys;
+    }
+
+  single->offset = 0;
+  single->keys = keys;
+  single->inverted = FALSE;
+  *parts = single;
+  return 1;
+}
+
+/* Either @keys or @other may not be multi sort keys */
+static gboolean
+gtk_multi_sort_keys_can_convert (GtkSortKeys *keys,
+                                 GtkSortKeys *other)
+{
+  GtkMultiSortKey *parts, *other_parts, single, other_single;
+  guint i, j, n_parts, n_other_parts;
+
+  n_parts = gtk_multi_sort_keys_get_parts (keys, &parts, &single);
+  n_other_parts = gtk_multi_sort_keys_get_parts (other, &other_parts, &other_single);
+
+  for (i = 0; i < n_parts; i++)
+    {
+      for (j = 0; j < n_other_parts; j++)
+        {
+          if (gtk_sort_keys_is_compatible (parts[i].keys, other_parts[j].keys))
+            return TRUE;
+        }
+    }
+
+  return FALSE;
+}
+
+/* Finds the part of @other_parts that each of @parts can reuse,
+ * or -1 if there is none. Each part of @other_parts is used once.
+ */
+static void
+gtk_multi_sort_keys_match_parts (GtkMultiSortKey *parts,
+                                 guint            n_parts,
+                                 GtkMultiSortKey *other_parts,
+                                 guint            n_other_parts,
+                                 int             *matches)
+{
+  gboolean *used;
+  guint i, j;
+
+  used = g_newa (gboolean, n_other_parts);
+  memset (used, 0, sizeof (gboolean) * n_other_parts);
+
+  for (i = 0; i < n_parts; i++)
+    {
+      matches[i] = -1;
+
+      for (j = 0; j < n_other_parts; j++)
+        {
+          if (!used[j] && gtk_sort_keys_is_compatible (parts[i].keys, other_parts[j].keys))
+            {
+              matches[i] = j;
+              used[j] = TRUE;
+              break;
+            }
+        }
+    }
+}
+
+/* Only parts that can't be reused need the item */
+static gboolean
+gtk_multi_sort_keys_convert_needs_item (GtkSortKeys *keys,
+                                        GtkSortKeys *other)
+{
+  GtkMultiSortKey *parts, *other_parts, single, other_single;
+  guint i, n_parts, n_other_parts;
+  int *matches;
+
+  n_parts = gtk_multi_sort_keys_get_parts (keys, &parts, &single);
+  n_other_parts = gtk_multi_sort_keys_get_parts (other, &other_parts, &other_single);
+  matches = g_newa (int, n_parts);
+  gtk_multi_sort_keys_match_parts (parts, n_parts, other_parts, n_other_parts, matches);
+
+  for (i = 0; i < n_parts; i++)
+    {
+      if (matches[i] < 0)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+/* Moves the parts of the old key that are still needed, so
+ * adding, removing or reordering sorters only needs to create
+ * keys for the sorters that were added.
+ */
+static void
+gtk_multi_sort_keys_convert_key (GtkSortKeys *keys,
+                                 gpointer     item,
+                                 gpointer     key_memory,
+                                 GtkSortKeys *other,
+                                 gpointer     other_key_memory)
+{
+  GtkMultiSortKey *parts, *other_parts, single, other_single;
+  char *key = (char *) key_memory;
+  char *other_key = (char *) other_key_memory;
+  guint i, j, n_parts, n_other_parts;
+  gboolean *used;
+  int *matches;
+
+  n_parts = gtk_multi_sort_keys_get_parts (keys, &parts, &single);
+  n_other_parts = gtk_multi_sort_keys_get_parts (other, &other_parts, &other_single);
+  matches = g_newa (int, n_parts);
+  gtk_multi_sort_keys_match_parts (parts, n_parts, other_parts, n_other_parts, matches);
+  used = g_newa (gboolean, n_other_parts);
+  memset (used, 0, sizeof (gboolean) * n_other_parts);
+
+  for (i = 0; i < n_parts; i++)
+    {
+      if (matches[i] >= 0)
+        {
+          memcpy (key + parts[i].offset,
+                  other_key + other_parts[matches[i]].offset,
+                  gtk_sort_keys_get_key_size (parts[i].keys));
+          used[matches[i]] = TRUE;
+        }
+      else
+        {
+          g_assert (item != NULL);
+          gtk_sort_keys_init_key (parts[i].keys, item, key + parts[i].offset);
+        }
+    }
+
+  for (j = 0; j < n_other_parts; j++)
+    {
+      if (!used[j])
+        gtk_sort_keys_clear_key (other_parts[j].keys, other_key + other_parts[j].offset);
+    }
+}
+
+/*<private>
+ * gtk_multi_sort_keys_new:
+ * @sorters: (array length=n_sorters): the sorters to combine
+ * @inverted: (array length=n_sorters) (nullable): whether to invert
+ *     the result of each of the sorters
+ * @n_sorters: the number of sorters
+ *
+ * Creates sort keys that compare by each of the @sorters in turn,
+ * like #GtkMultiSorter does.
+ *
+ * Returns: the new sort keys
+ **/
+GtkSortKeys *
+gtk_multi_sort_keys_new (GtkSorter * const *sorters,
+                         const gboolean    *inverted,
+                         guint              n_sorters)
 {
   GtkMultiSortKeys *result;
-  GtkSortKeys *keys;
+  GtkSortKeys *keys, *first;
   gsize i;
 
-  if (gtk_sorters_get_size (&self->sorters) == 0)
+  if (n_sorters == 0)
     return gtk_sort_keys_new_equal ();
-  else if (gtk_sorters_get_size (&self->sorters) == 1)
-    return gtk_sorter_get_keys (gtk_sorters_get (&self->sorters, 0));
-
-  keys = gtk_sort_keys_alloc (&GTK_MULTI_SORT_KEYS_CLASS,
-                              sizeof (GtkMultiSortKeys) + gtk_sorters_get_size (&self->sorters) * sizeof (GtkMultiSortKey),
+  else if (n_sorters == 1 && (inverted == NULL || !inverted[0]))
+    return gtk_sorter_get_keys (sorters[0]);
+
+  first = gtk_sorter_get_keys (sorters[0]);
+  keys = gtk_sort_keys_alloc (gtk_sort_keys_has_key_prefix (first)
+                              ? &GTK_MULTI_SORT_KEYS_PREFIX_CLASS
+                              : &GTK_MULTI_SORT_KEYS_CLASS,
+                              sizeof (GtkMultiSortKeys) + n_sorters * sizeof (GtkMultiSortKey),
                               0, 1);
   result = (GtkMultiSortKeys *) keys;
 
-  result->n_keys = gtk_sorters_get_size (&self->sorters);
+  result->n_keys = n_sorters;
+  keys->thread_safe = TRUE;
+  keys->exact_prefix = FALSE;
   for (i = 0; i < result->n_keys; i++)
     {
-      result->keys[i].keys = gtk_sorter_get_keys (gtk_sorters_get (&self->sorters, i));
+      result->keys[i].keys = i == 0 ? first : gtk_sorter_get_keys (sorters[i]);
+      result->keys[i].inverted = inverted ? inverted[i] : FALSE;
+      keys->thread_safe &= gtk_sort_keys_is_thread_safe (result->keys[i].keys);
       result->keys[i].offset = GTK_SORT_KEYS_ALIGN (keys->key_size, gtk_sort_keys_get_key_align (result->keys[i].keys));
       keys->key_size = result->keys[i].offset + gtk_sort_keys_get_key_size (result->keys[i].keys);
       keys->key_align = MAX (keys->key_align, gtk_sort_keys_get_key_align (result->keys[i].keys));
@@ -184,6 +406,14 @@ gtk_multi_sort_keys_new (GtkMultiSorter *self)
   return keys;
 }
 
+static GtkSortKeys *
+gtk_multi_sorter_get_keys (GtkMultiSorter *self)
+{
+  return gtk_multi_sort_keys_new ((GtkSorter * const *) gtk_sorters_get_data (&self->sorters),
+                                  NULL,
+                                  gtk_sorters_get_size (&self->sorters));
+}
+
 static GType
 gtk_multi_sorter_get_item_type (GListModel *list)
 {
@@ -307,10 +537,11 @@ gtk_multi_sorter_changed_cb (GtkSorter       *sorter,
   switch (change)
   {
     case GTK_SORTER_CHANGE_INVERTED:
-      /* This could do a lot better with change handling, in particular in
-       * cases where self->n_sorters == 1 or if sorter == self->sorters[0]
+      /* This could do a lot better with change handling, in particular
+       * if sorter == self->sorters[0]
        */
-      change = GTK_SORTER_CHANGE_DIFFERENT;
+      if (gtk_sorters_get_size (&self->sorters) != 1)
+        change = GTK_SORTER_CHANGE_DIFFERENT;
       break;
 
     case GTK_SORTER_CHANGE_DIFFERENT:
@@ -324,7 +555,7 @@ gtk_multi_sorter_changed_cb (GtkSorter       *sorter,
   }
   gtk_sorter_changed_with_keys (GTK_SORTER (self),
                                 change,
-                                gtk_multi_sort_keys_new (self));
+                                gtk_multi_sorter_get_keys (self));
 }
 
 static void
@@ -362,7 +593,7 @@ gtk_multi_sorter_init (GtkMultiSorter *self)
 
   gtk_sorter_changed_with_keys (GTK_SORTER (self),
                                 GTK_SORTER_CHANGE_DIFFERENT,
-                                gtk_multi_sort_keys_new (self));
+                                gtk_multi_sorter_get_keys (self));
 }
 
 /**
@@ -404,7 +635,7 @@ gtk_multi_sorter_append (GtkMultiSorter *self,
 
   gtk_sorter_changed_with_keys (GTK_SORTER (self),
                                 GTK_SORTER_CHANGE_MORE_STRICT,
-                                gtk_multi_sort_keys_new (self));
+                                gtk_multi_sorter_get_keys (self));
 }
 
 /**
@@ -436,6 +667,6 @@ gtk_multi_sorter_remove (GtkMultiSorter *self,
 
   gtk_sorter_changed_with_keys (GTK_SORTER (self),
                                 GTK_SORTER_CHANGE_LESS_STRICT,
-                                gtk_multi_sort_keys_new (self));
+                                gtk_multi_sorter_get_keys (self));
 }
 
@@ -23,6 +23,7 @@
 
 #include "gtkbitset.h"
 #include "gtkintl.h"
+#include "gtkprefetchableprivate.h"
 #include "gtkselectionmodel.h"
 
 /**
@@ -116,11 +117,29 @@ gtk_no_selection_selection_model_init (GtkSelectionModelInterface *iface)
   iface->get_selection_in_range = gtk_no_selection_get_selection_in_range;
 }
 
+static void
+gtk_no_selection_prefetch (GtkPrefetchable *prefetchable,
+                           guint            position,
+                           guint            n_items)
+{
+  GtkNoSelection *self = GTK_NO_SELECTION (prefetchable);
+
+  gtk_prefetchable_forward (self->model, position, n_items);
+}
+
+static void
+gtk_no_selection_prefetchable_init (GtkPrefetchableInterface *iface)
+{
+  iface->prefetch = gtk_no_selection_prefetch;
+}
+
 G_DEFINE_TYPE_EXTENDED (GtkNoSelection, gtk_no_selection, G_TYPE_OBJECT, 0,
                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL,
                                                gtk_no_selection_list_model_init)
                         G_IMPLEMENT_INTERFACE (GTK_TYPE_SELECTION_MODEL,
-                                               gtk_no_selection_selection_model_init))
+                                               gtk_no_selection_selection_model_init)
+                        G_IMPLEMENT_INTERFACE (GTK_TYPE_PREFETCHABLE,
+                                               gtk_no_selection_prefetchable_init))
 
 static void
 gtk_no_selection_clear_model (GtkNoSelection *self)
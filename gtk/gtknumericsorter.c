@@ -26,6 +26,7 @@
 #include "gtktypebuiltins.h"
 
 #include <math.h>
+#include <string.h>
 
 /**
  * SECTION:gtknumericsorter
@@ -144,6 +145,57 @@ COMPARE_FUNCS(gulong)
 COMPARE_FUNCS(gint64)
 COMPARE_FUNCS(guint64)
 
+/* Prefixes map the numbers to unsigned 64bit integers that sort
+ * the same way. Descending order just inverts all the bits.
+ */
+#define PREFIX_FUNC(type, name, _invert, _to_unsigned) \
+static guint64 \
+gtk_ ## type ## _sort_keys_get_prefix_ ## name (GtkSortKeys   *keys, \
+                                                gconstpointer  key_memory) \
+{ \
+  type num = *(type *) key_memory; \
+  guint64 result = _to_unsigned (num); \
+\
+  return _invert ? ~result : result; \
+}
+#define PREFIX_FUNCS(type, _to_unsigned) \
+  PREFIX_FUNC(type, ascending, FALSE, _to_unsigned) \
+  PREFIX_FUNC(type, descending, TRUE, _to_unsigned)
+
+#define SIGN_BIT G_GUINT64_CONSTANT (0x8000000000000000)
+#define SIGNED_TO_UNSIGNED(num) (((guint64) (gint64) (num)) ^ SIGN_BIT)
+#define UNSIGNED_TO_UNSIGNED(num) ((guint64) (num))
+
+static inline guint64
+double_to_unsigned (double num)
+{
+  guint64 bits;
+
+  /* NaNs sort last, just like in the compare function */
+  if (isnan (num))
+    return G_MAXUINT64;
+  /* make -0.0 and 0.0 equal */
+  if (num == 0.0)
+    num = 0.0;
+
+  memcpy (&bits, &num, sizeof (bits));
+  if (bits & SIGN_BIT)
+    return ~bits;
+  else
+    return bits | SIGN_BIT;
+}
+
+PREFIX_FUNCS(char, SIGNED_TO_UNSIGNED)
+PREFIX_FUNCS(guchar, UNSIGNED_TO_UNSIGNED)
+PREFIX_FUNCS(int, SIGNED_TO_UNSIGNED)
+PREFIX_FUNCS(guint, UNSIGNED_TO_UNSIGNED)
+PREFIX_FUNCS(float, double_to_unsigned)
+PREFIX_FUNCS(double, double_to_unsigned)
+PREFIX_FUNCS(long, SIGNED_TO_UNSIGNED)
+PREFIX_FUNCS(gulong, UNSIGNED_TO_UNSIGNED)
+PREFIX_FUNCS(gint64, SIGNED_TO_UNSIGNED)
+PREFIX_FUNCS(guint64, UNSIGNED_TO_UNSIGNED)
+
 G_GNUC_BEGIN_IGNORE_DEPRECATIONS
 
 #define NUMERIC_SORT_KEYS(TYPE, key_type, type, default_value) \
@@ -174,7 +226,10 @@ static const GtkSortKeysClass GTK_ASCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
   gtk_ ## key_type ## _sort_keys_compare_ascending, \
   gtk_ ## type ## _sort_keys_is_compatible, \
   gtk_ ## type ## _sort_keys_init_key, \
-  NULL \
+  NULL, \
+  NULL, \
+  NULL, \
+  gtk_ ## key_type ## _sort_keys_get_prefix_ascending, \
 }; \
 \
 static const GtkSortKeysClass GTK_DESCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
@@ -183,15 +238,18 @@ static const GtkSortKeysClass GTK_DESCENDING_ ## TYPE ## _SORT_KEYS_CLASS = \
   gtk_ ## key_type ## _sort_keys_compare_descending, \
   gtk_ ## type ## _sort_keys_is_compatible, \
   gtk_ ## type ## _sort_keys_init_key, \
-  NULL \
+  NULL, \
+  NULL, \
+  NULL, \
+  gtk_ ## key_type ## _sort_keys_get_prefix_descending, \
 }; \
 \
 static gboolean \
 gtk_ ## type ## _sort_keys_is_compatible (GtkSortKeys *keys, \
                                           GtkSortKeys *other) \
 { \
-  GtkNumericSorter *self = (GtkNumericSorter *) keys; \
-  GtkNumericSorter *compare = (GtkNumericSorter *) other; \
+  GtkNumericSortKeys *self = (GtkNumericSortKeys *) keys; \
+  GtkNumericSortKeys *compare = (GtkNumericSortKeys *) other; \
 \
   if (other->klass != &GTK_ASCENDING_ ## TYPE ## _SORT_KEYS_CLASS && \
       other->klass != &GTK_DESCENDING_ ## TYPE ## _SORT_KEYS_CLASS) \
@@ -329,6 +387,8 @@ gtk_numeric_sort_keys_new (GtkNumericSorter *self)
     }
 
   result->expression = gtk_expression_ref (self->expression);
+  result->keys.thread_safe = TRUE;
+  result->keys.exact_prefix = TRUE;
 
   return (GtkSortKeys *) result;
 }
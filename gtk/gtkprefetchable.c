@@ -0,0 +1,110 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "gtkprefetchableprivate.h"
+
+/**
+ * SECTION:gtkprefetchable
+ * @Title: GtkPrefetchable
+ * @Short_description: A list model that can load items ahead of time
+ * @See_also: #GListModel, #GtkListView, #GtkGridView
+ *
+ * #GtkPrefetchable is an interface for list models that load their items
+ * lazily, for example from disk or from a database.
+ *
+ * List widgets like #GtkListView call gtk_prefetchable_prefetch() with the
+ * range of items they expect to display next, based on the visible range and
+ * the direction and speed of scrolling. Models can use this hint to load
+ * those items in batches ahead of time.
+ *
+ * The list models provided by GTK that wrap other models, like
+ * #GtkFilterListModel or #GtkSingleSelection, implement this interface
+ * by forwarding the hint to the model they wrap.
+ *
+ * Prefetching is only a hint. Models are free to ignore it and must
+ * still return all items when they are requested.
+ */
+
+G_DEFINE_INTERFACE (GtkPrefetchable, gtk_prefetchable, G_TYPE_LIST_MODEL)
+
+static void
+gtk_prefetchable_default_prefetch (GtkPrefetchable *self,
+                                   guint            position,
+                                   guint            n_items)
+{
+}
+
+static void
+gtk_prefetchable_default_init (GtkPrefetchableInterface *iface)
+{
+  iface->prefetch = gtk_prefetchable_default_prefetch;
+}
+
+/**
+ * gtk_prefetchable_prefetch:
+ * @self: a #GtkPrefetchable
+ * @position: the first item to prefetch
+ * @n_items: the number of items to prefetch
+ *
+ * Hints to @self that the items in the given range will be
+ * requested soon.
+ *
+ * A new call replaces the hints given by previous calls.
+ *
+ * Since: 4.2
+ */
+void
+gtk_prefetchable_prefetch (GtkPrefetchable *self,
+                           guint            position,
+                           guint            n_items)
+{
+  GtkPrefetchableInterface *iface;
+
+  g_return_if_fail (GTK_IS_PREFETCHABLE (self));
+
+  if (n_items == 0)
+    return;
+
+  iface = GTK_PREFETCHABLE_GET_IFACE (self);
+  iface->prefetch (self, position, n_items);
+}
+
+/*
+ * gtk_prefetchable_forward:
+ * @model: (nullable): a #GListModel
+ * @position: the first item to prefetch
+ * @n_items: the number of items to prefetch
+ *
+ * Calls gtk_prefetchable_prefetch() on @model if it supports it.
+ * This is meant to be used by models that wrap other models.
+ */
+void
+gtk_prefetchable_forward (GListModel *model,
+                          guint       position,
+                          guint       n_items)
+{
+  guint model_n_items;
+
+  if (!GTK_IS_PREFETCHABLE (model))
+    return;
+
+  model_n_items = g_list_model_get_n_items (model);
+  if (position >= model_n_items)
+    return;
+
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (model), position, MIN (n_items, model_n_items - position));
+}
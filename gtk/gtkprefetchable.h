@@ -0,0 +1,56 @@
+/*
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef __GTK_PREFETCHABLE_H__
+#define __GTK_PREFETCHABLE_H__
+
+#if !defined (__GTK_H_INSIDE__) && !defined (GTK_COMPILATION)
+#error "Only <gtk/gtk.h> can be included directly."
+#endif
+
+#include <gtk/gtktypes.h>
+
+G_BEGIN_DECLS
+
+#define GTK_TYPE_PREFETCHABLE       (gtk_prefetchable_get_type ())
+
+GDK_AVAILABLE_IN_4_2
+G_DECLARE_INTERFACE (GtkPrefetchable, gtk_prefetchable, GTK, PREFETCHABLE, GListModel)
+
+/**
+ * GtkPrefetchableInterface:
+ * @prefetch: Hint that the items in the given range will be needed soon.
+ *
+ * The list of virtual functions for the #GtkPrefetchable interface.
+ */
+struct _GtkPrefetchableInterface
+{
+  /*< private >*/
+  GTypeInterface g_iface;
+
+  /*< public >*/
+  void                  (* prefetch)                            (GtkPrefetchable        *self,
+                                                                 guint                   position,
+                                                                 guint                   n_items);
+};
+
+GDK_AVAILABLE_IN_4_2
+void                    gtk_prefetchable_prefetch               (GtkPrefetchable        *self,
+                                                                 guint                   position,
+                                                                 guint                   n_items);
+
+G_END_DECLS
+
+#endif /* __GTK_PREFETCHABLE_H__ */
@@ -21,6 +21,8 @@
 
 #include "gtkdebug.h"
 
+#include <string.h>
+
 /* Define the following to print adds and removals to stdout.
  * The format of the printout will be suitable for addition as a new test to
  * testsuite/gtk/rbtree-crash.c
@@ -30,7 +32,22 @@
  */
 #undef DUMP_MODIFICATION
 
+/* Nodes are allocated from slabs owned by the tree. The first slab holds
+ * this many nodes, every following slab holds twice as many as the
+ * previous one, up to the maximum.
+ * Removed nodes are kept on a free list of their slab for reuse. Once
+ * all nodes of a slab are free, the slab is released, unless new nodes
+ * are still being handed out from it.
+ */
+#define GTK_RB_SLAB_MIN_NODES 8
+#define GTK_RB_SLAB_MAX_NODES 1024
+
+#define GTK_RB_ALIGN(size, align) (((size) + (align) - 1) & ~((gsize) (align) - 1))
+/* same alignment g_slice uses */
+#define GTK_RB_NODE_ALIGN (2 * sizeof (gpointer))
+
 typedef struct _GtkRbNode GtkRbNode;
+typedef struct _GtkRbSlab GtkRbSlab;
 
 struct _GtkRbTree
 {
@@ -38,17 +55,40 @@ struct _GtkRbTree
 
   gsize element_size;
   gsize augment_size;
+  gsize node_size; /* aligned size of node + element + augment */
   GtkRbTreeAugmentFunc augment_func;
   GDestroyNotify clear_func;
   GDestroyNotify clear_augment_func;
 
   GtkRbNode *root;
+  gsize n_nodes;
+
+  GtkRbSlab **slabs; /* indexed by GtkRbNode.slab, released slabs are NULL */
+  guint n_slabs; /* size of the slabs array */
+  GtkRbSlab *fresh_slab; /* slab that untouched nodes are handed out from */
+  GtkRbSlab *free_slabs; /* slabs with freed nodes */
+  gsize next_slab_size;
+};
+
+struct _GtkRbSlab
+{
+  guint index; /* in tree->slabs */
+  gsize n_nodes; /* number of nodes in this slab */
+  gsize n_used; /* number of nodes handed out, the others are untouched */
+  gsize n_live; /* number of nodes in use */
+  GtkRbNode *free_nodes; /* freed nodes, linked via their left pointer */
+  GtkRbSlab *prev_free; /* links in tree->free_slabs */
+  GtkRbSlab *next_free;
 };
 
+#define SLAB_HEADER_SIZE GTK_RB_ALIGN (sizeof (GtkRbSlab), GTK_RB_NODE_ALIGN)
+#define SLAB_NODE(tree, slab, i) ((GtkRbNode *) (((guchar *) (slab)) + SLAB_HEADER_SIZE + (i) * (tree)->node_size))
+
 struct _GtkRbNode
 {
   guint red :1;
   guint dirty :1;
+  guint slab :30; /* index of the slab the node was allocated from */
 
   GtkRbNode *left;
   GtkRbNode *right;
@@ -106,18 +146,117 @@ set_parent (GtkRbTree *tree,
     }
 }
 
-static inline gsize
-gtk_rb_node_get_size (GtkRbTree *tree)
+static void
+gtk_rb_slab_link_free (GtkRbTree *tree,
+                       GtkRbSlab *slab)
+{
+  slab->prev_free = NULL;
+  slab->next_free = tree->free_slabs;
+  if (tree->free_slabs)
+    tree->free_slabs->prev_free = slab;
+  tree->free_slabs = slab;
+}
+
+static void
+gtk_rb_slab_unlink_free (GtkRbTree *tree,
+                         GtkRbSlab *slab)
+{
+  if (slab->prev_free)
+    slab->prev_free->next_free = slab->next_free;
+  else
+    tree->free_slabs = slab->next_free;
+  if (slab->next_free)
+    slab->next_free->prev_free = slab->prev_free;
+}
+
+static GtkRbSlab *
+gtk_rb_slab_new (GtkRbTree *tree)
+{
+  GtkRbSlab *slab;
+  guint i;
+
+  for (i = 0; i < tree->n_slabs; i++)
+    {
+      if (tree->slabs[i] == NULL)
+        break;
+    }
+  if (i == tree->n_slabs)
+    {
+      tree->n_slabs = MAX (2 * tree->n_slabs, 8);
+      tree->slabs = g_renew (GtkRbSlab *, tree->slabs, tree->n_slabs);
+      memset (tree->slabs + i, 0, sizeof (GtkRbSlab *) * (tree->n_slabs - i));
+    }
+
+  slab = g_malloc (SLAB_HEADER_SIZE + tree->next_slab_size * tree->node_size);
+  slab->index = i;
+  slab->n_nodes = tree->next_slab_size;
+  slab->n_used = 0;
+  slab->n_live = 0;
+  slab->free_nodes = NULL;
+  tree->slabs[i] = slab;
+
+  tree->next_slab_size = MIN (tree->next_slab_size * 2, GTK_RB_SLAB_MAX_NODES);
+
+  return slab;
+}
+
+static void
+gtk_rb_slab_free (GtkRbTree *tree,
+                  GtkRbSlab *slab)
 {
-  return sizeof (GtkRbNode) + tree->element_size + tree->augment_size;
+  if (slab->free_nodes)
+    gtk_rb_slab_unlink_free (tree, slab);
+  if (tree->fresh_slab == slab)
+    tree->fresh_slab = NULL;
+
+  tree->slabs[slab->index] = NULL;
+  g_free (slab);
+}
+
+static GtkRbNode *
+gtk_rb_node_alloc (GtkRbTree *tree,
+                   guint     *out_slab)
+{
+  GtkRbSlab *slab;
+  GtkRbNode *result;
+
+  slab = tree->free_slabs;
+  if (slab)
+    {
+      result = slab->free_nodes;
+      slab->free_nodes = result->left;
+      if (slab->free_nodes == NULL)
+        gtk_rb_slab_unlink_free (tree, slab);
+    }
+  else
+    {
+      slab = tree->fresh_slab;
+      if (slab == NULL || slab->n_used == slab->n_nodes)
+        {
+          slab = gtk_rb_slab_new (tree);
+          tree->fresh_slab = slab;
+        }
+
+      result = SLAB_NODE (tree, slab, slab->n_used);
+      slab->n_used++;
+    }
+
+  slab->n_live++;
+  *out_slab = slab->index;
+
+  return result;
 }
 
 static GtkRbNode *
 gtk_rb_node_new (GtkRbTree *tree)
 {
   GtkRbNode *result;
+  guint slab;
 
-  result = g_slice_alloc0 (gtk_rb_node_get_size (tree));
+  result = gtk_rb_node_alloc (tree, &slab);
+  memset (result, 0, tree->node_size);
+  result->slab = slab;
+  tree->n_nodes++;
 
   result->red = TRUE;
   result->dirty = TRUE;
@@ -126,30 +265,69 @@ gtk_rb_node_new (GtkRbTree *tree)
 }
 
 static void
-gtk_rb_node_free (GtkRbTree *tree,
-                  GtkRbNode *node)
+gtk_rb_node_clear (GtkRbTree *tree,
+                   GtkRbNode *node)
 {
   if (tree->clear_func)
     tree->clear_func (NODE_TO_POINTER (node));
   if (tree->clear_augment_func)
     tree->clear_augment_func (NODE_TO_AUG_POINTER (tree, node));
-
-  g_slice_free1 (gtk_rb_node_get_size (tree), node);
 }
 
 static void
-gtk_rb_node_free_deep (GtkRbTree *tree,
-                       GtkRbNode *node)
+gtk_rb_node_free (GtkRbTree *tree,
+                  GtkRbNode *node)
 {
-  GtkRbNode *right = node->right;
+  GtkRbSlab *slab = tree->slabs[node->slab];
 
+  gtk_rb_node_clear (tree, node);
+  tree->n_nodes--;
+
+  slab->n_live--;
+  if (slab->n_live == 0 && slab != tree->fresh_slab)
+    {
+      gtk_rb_slab_free (tree, slab);
+      return;
+    }
+
+  if (slab->free_nodes == NULL)
+    gtk_rb_slab_link_free (tree, slab);
+  node->left = slab->free_nodes;
+  slab->free_nodes = node;
+}
+
+static void
+gtk_rb_node_clear_deep (GtkRbTree *tree,
+                        GtkRbNode *node)
+{
   if (node->left)
-    gtk_rb_node_free_deep (tree, node->left);
+    gtk_rb_node_clear_deep (tree, node->left);
 
-  gtk_rb_node_free (tree, node);
+  gtk_rb_node_clear (tree, node);
 
-  if (right)
-    gtk_rb_node_free_deep (tree, right);
+  if (node->right)
+    gtk_rb_node_clear_deep (tree, node->right);
+}
+
+/* Frees all nodes at once by releasing the slabs. */
+static void
+gtk_rb_tree_free_nodes (GtkRbTree *tree)
+{
+  guint i;
+
+  if (tree->root && (tree->clear_func || tree->clear_augment_func))
+    gtk_rb_node_clear_deep (tree, tree->root);
+
+  tree->root = NULL;
+  tree->n_nodes = 0;
+  tree->fresh_slab = NULL;
+  tree->free_slabs = NULL;
+  tree->next_slab_size = GTK_RB_SLAB_MIN_NODES;
+
+  for (i = 0; i < tree->n_slabs; i++)
+    g_free (tree->slabs[i]);
+  g_clear_pointer (&tree->slabs, g_free);
+  tree->n_slabs = 0;
 }
 
 static void
@@ -516,9 +694,11 @@ gtk_rb_tree_new_for_size (gsize                element_size,
 
   tree->element_size = element_size;
   tree->augment_size = augment_size;
+  tree->node_size = GTK_RB_ALIGN (sizeof (GtkRbNode) + element_size + augment_size, GTK_RB_NODE_ALIGN);
   tree->augment_func = augment_func;
   tree->clear_func = clear_func;
   tree->clear_augment_func = clear_augment_func;
+  tree->next_slab_size = GTK_RB_SLAB_MIN_NODES;
 
   return tree;
 }
@@ -538,9 +718,8 @@ gtk_rb_tree_unref (GtkRbTree *tree)
   if (tree->ref_count > 0)
     return;
 
-  if (tree->root)
-    gtk_rb_node_free_deep (tree, tree->root);
-    
+  gtk_rb_tree_free_nodes (tree);
+
   g_slice_free (GtkRbTree, tree);
 }
 
@@ -707,6 +886,109 @@ gtk_rb_tree_insert_after (GtkRbTree *tree,
   return NODE_TO_POINTER (result);
 }
 
+/* Links the sorted @nodes into a perfectly balanced tree.
+ * All levels but the last one are full and black, the nodes
+ * on the last level are red.
+ */
+static GtkRbNode *
+gtk_rb_node_build (GtkRbNode **nodes,
+                   gsize       n_nodes,
+                   guint       depth,
+                   guint       red_depth)
+{
+  GtkRbNode *node;
+  gsize mid;
+
+  if (n_nodes == 0)
+    return NULL;
+
+  mid = n_nodes / 2;
+  node = nodes[mid];
+  node->red = depth == red_depth;
+  node->dirty = TRUE;
+
+  node->left = gtk_rb_node_build (nodes, mid, depth + 1, red_depth);
+  if (node->left)
+    node->left->parent = node;
+  node->right = gtk_rb_node_build (nodes + mid + 1, n_nodes - mid - 1, depth + 1, red_depth);
+  if (node->right)
+    node->right->parent = node;
+
+  return node;
+}
+
+/**
+ * gtk_rb_tree_insert_many_before:
+ * @tree: a #GtkRbTree
+ * @node: (nullable): the node to insert before or %NULL to append
+ * @n_nodes: number of nodes to insert
+ *
+ * Inserts @n_nodes new nodes before @node.
+ *
+ * If many nodes are added compared to the size of the tree, the
+ * whole tree is rebuilt in a balanced way in O(n) and the augments
+ * are only computed once, instead of rebalancing and marking the
+ * tree dirty for every single node.
+ * Existing nodes stay valid, but their augments get recomputed.
+ *
+ * Returns: (nullable): the first of the inserted nodes. Use
+ *     gtk_rb_tree_node_get_next() to get the others.
+ **/
+gpointer
+gtk_rb_tree_insert_many_before (GtkRbTree *tree,
+                                gpointer   node,
+                                gsize      n_nodes)
+{
+  GtkRbNode **nodes;
+  GtkRbNode *current, *first;
+  gsize i, j, n_total;
+
+  if (n_nodes == 0)
+    return NULL;
+
+  n_total = tree->n_nodes + n_nodes;
+
+  /* Inserting one by one costs O(log n) per node, rebuilding O(n) */
+  if (n_nodes * g_bit_storage (n_total) < n_total)
+    {
+      first = gtk_rb_tree_insert_before (tree, node);
+      for (i = 1; i < n_nodes; i++)
+        gtk_rb_tree_insert_before (tree, node);
+
+      return first;
+    }
+
+#ifdef DUMP_MODIFICATION
+  g_print ("add_many (tree, %u, %zu); /* 0x%p */\n",
+           node ? position (tree, NODE_FROM_POINTER (node)) : (guint) tree->n_nodes, n_nodes, tree);
+#endif /* DUMP_MODIFICATION */
+
+  nodes = g_new (GtkRbNode *, n_total);
+  i = 0;
+
+  for (current = tree->root ? gtk_rb_node_get_first (tree->root) : NULL;
+       current != NULL && NODE_TO_POINTER (current) != node;
+       current = gtk_rb_node_get_next (current))
+    nodes[i++] = current;
+
+  first = gtk_rb_node_new (tree);
+  nodes[i++] = first;
+  for (j = 1; j < n_nodes; j++)
+    nodes[i++] = gtk_rb_node_new (tree);
+
+  for (; current != NULL; current = gtk_rb_node_get_next (current))
+    nodes[i++] = current;
+
+  g_assert (i == n_total);
+
+  tree->root = gtk_rb_node_build (nodes, n_total, 0, g_bit_storage (n_total + 1) - 1);
+  set_parent (tree, tree->root, NULL);
+
+  g_free (nodes);
+
+  return NODE_TO_POINTER (first);
+}
+
 void
 gtk_rb_tree_remove (GtkRbTree *tree,
                     gpointer   node)
@@ -792,9 +1074,6 @@ gtk_rb_tree_remove_all (GtkRbTree *tree)
       g_print ("delete_all (tree); /* 0x%p */\n", tree);
 #endif /* DUMP_MODIFICATION */
 
-  if (tree->root)
-    gtk_rb_node_free_deep (tree, tree->root);
-
-  tree->root = NULL;
+  gtk_rb_tree_free_nodes (tree);
 }
 
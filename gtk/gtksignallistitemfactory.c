@@ -23,7 +23,7 @@
 
 #include "gtkintl.h"
 #include "gtklistitemfactoryprivate.h"
-#include "gtklistitem.h"
+#include "gtklistitemprivate.h"
 
 /**
  * SECTION:gtksignallistitemfactory
@@ -70,11 +70,58 @@
  * #GtkListItem::notify signal is recommended. The signal can be connected
  * in the #GtkSignalListItemFactory::setup signal and removed again during
  * #GtkSignalListItemFactory::teardown.
+ *
+ * # Preparing items in a thread
+ *
+ * If binding an item requires expensive computations, like loading
+ * thumbnails or formatting large texts, this work can be moved to a
+ * worker thread with gtk_signal_list_item_factory_set_prepare_func().
+ *
+ * The prepare function is given the item and returns the data needed
+ * to bind it. While it runs, #GtkSignalListItemFactory::bind is emitted
+ * as usual, but gtk_signal_list_item_factory_get_prepared_data() returns
+ * %NULL, so the listitem can show a placeholder. Once the data is ready,
+ * the listitem is unbound and bound again, this time with the prepared data.
+ * If the listitem is bound to a different item before that happens,
+ * the prepare function's cancellable is cancelled and its result is
+ * discarded. Listitems that are only bound to measure them, like when
+ * a #GtkListView estimates the height of rows that are not shown, are
+ * not prepared.
+ */
+
+typedef struct _GtkListItemPrepare GtkListItemPrepare;
+typedef struct _GtkListItemPrepareTask GtkListItemPrepareTask;
+
+/* The prepare function as set with set_prepare_func(). Every task keeps
+ * a reference, so changing the function doesn't free the user data
+ * while it is in use. Only referenced and unreferenced on the main thread.
  */
+struct _GtkListItemPrepare
+{
+  guint ref_count;
+
+  GtkListItemPrepareFunc func;
+  GDestroyNotify data_destroy;
+  gpointer user_data;
+  GDestroyNotify user_destroy;
+};
+
+/* All references held by a task are released on the main thread
+ * in gtk_signal_list_item_factory_prepare_done().
+ */
+struct _GtkListItemPrepareTask
+{
+  GtkSignalListItemFactory *factory;
+  GtkListItemPrepare *prepare;
+  GtkListItem *list_item;
+  gpointer item;
+};
 
 struct _GtkSignalListItemFactory
 {
   GtkListItemFactory parent_instance;
+
+  GtkListItemPrepare *prepare;
 };
 
 struct _GtkSignalListItemFactoryClass
@@ -103,17 +150,187 @@ enum {
 G_DEFINE_TYPE (GtkSignalListItemFactory, gtk_signal_list_item_factory, GTK_TYPE_LIST_ITEM_FACTORY)
 static guint signals[LAST_SIGNAL] = { 0 };
 
+static GtkListItemPrepare *
+gtk_list_item_prepare_ref (GtkListItemPrepare *prepare)
+{
+  prepare->ref_count++;
+
+  return prepare;
+}
+
+static void
+gtk_list_item_prepare_unref (GtkListItemPrepare *prepare)
+{
+  prepare->ref_count--;
+  if (prepare->ref_count > 0)
+    return;
+
+  if (prepare->user_destroy)
+    prepare->user_destroy (prepare->user_data);
+
+  g_slice_free (GtkListItemPrepare, prepare);
+}
+
+/* Runs in the prepare pool, which owns a reference to @data. */
+static void
+gtk_signal_list_item_factory_prepare_thread (gpointer data,
+                                             gpointer user_data)
+{
+  GTask *task = data;
+  GtkListItemPrepareTask *task_data = g_task_get_task_data (task);
+  GtkListItemPrepare *prepare = task_data->prepare;
+
+  /* Items scrolled out of view before their turn came are skipped */
+  if (!g_task_return_error_if_cancelled (task))
+    {
+      /* The result is always propagated in prepare_done(), so it's
+       * freed on the main thread, too. */
+      g_task_return_pointer (task,
+                             prepare->func (task_data->item,
+                                            g_task_get_cancellable (task),
+                                            prepare->user_data),
+                             NULL);
+    }
+
+  g_object_unref (task);
+}
+
+/* A dedicated pool, so that slow prepare functions can't starve
+ * the GIO worker threads, and that at most one prepare function
+ * per processor runs at a time.
+ */
+static GThreadPool *
+gtk_signal_list_item_factory_get_pool (void)
+{
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (gtk_signal_list_item_factory_prepare_thread,
+                                    NULL,
+                                    g_get_num_processors (),
+                                    FALSE,
+                                    NULL);
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  return pool;
+}
+
+static void
+gtk_signal_list_item_factory_prepare_done (GObject      *source,
+                                           GAsyncResult *result,
+                                           gpointer      user_data)
+{
+  GtkListItemPrepareTask *task_data = g_task_get_task_data (G_TASK (result));
+  GtkSignalListItemFactory *self = task_data->factory;
+  GtkListItem *list_item = task_data->list_item;
+  GDestroyNotify data_destroy = task_data->prepare->data_destroy;
+  gpointer data;
+
+  data = g_task_propagate_pointer (G_TASK (result), NULL);
+
+  /* the listitem was unbound in the meantime */
+  if (list_item->prepare_cancellable != g_task_get_cancellable (G_TASK (result)))
+    {
+      if (data && data_destroy)
+        data_destroy (data);
+    }
+  else
+    {
+      g_clear_object (&list_item->prepare_cancellable);
+
+      if (data)
+        {
+          g_object_freeze_notify (G_OBJECT (list_item));
+
+          g_signal_emit (self, signals[UNBIND], 0, list_item);
+          list_item->prepared_data = data;
+          list_item->prepared_data_destroy = data_destroy;
+          g_signal_emit (self, signals[BIND], 0, list_item);
+
+          g_object_thaw_notify (G_OBJECT (list_item));
+        }
+    }
+
+  g_object_unref (task_data->item);
+  g_object_unref (task_data->list_item);
+  gtk_list_item_prepare_unref (task_data->prepare);
+  g_object_unref (task_data->factory);
+  g_slice_free (GtkListItemPrepareTask, task_data);
+}
+
+static void
+gtk_signal_list_item_factory_bind (GtkSignalListItemFactory *self,
+                                   GtkListItem              *list_item)
+{
+  /* rows that are only measured show the placeholder */
+  if (self->prepare && !gtk_list_item_widget_get_measuring (list_item->owner))
+    {
+      GtkListItemPrepareTask *task_data;
+      GTask *task;
+
+      list_item->prepare_cancellable = g_cancellable_new ();
+
+      task_data = g_slice_new (GtkListItemPrepareTask);
+      task_data->factory = g_object_ref (self);
+      task_data->prepare = gtk_list_item_prepare_ref (self->prepare);
+      task_data->list_item = g_object_ref (list_item);
+      task_data->item = g_object_ref (gtk_list_item_get_item (list_item));
+
+      /* No source object and no destroy notify for the task data, the
+       * task may be finalized on the worker thread.
+       */
+      task = g_task_new (NULL,
+                         list_item->prepare_cancellable,
+                         gtk_signal_list_item_factory_prepare_done,
+                         NULL);
+      g_task_set_source_tag (task, gtk_signal_list_item_factory_bind);
+      g_task_set_check_cancellable (task, FALSE);
+      g_task_set_task_data (task, task_data, NULL);
+      /* the pool takes over our reference */
+      g_thread_pool_push (gtk_signal_list_item_factory_get_pool (), task, NULL);
+    }
+
+  g_signal_emit (self, signals[BIND], 0, list_item);
+}
+
+static void
+gtk_signal_list_item_factory_unbind (GtkSignalListItemFactory *self,
+                                     GtkListItem              *list_item)
+{
+  if (list_item->prepare_cancellable)
+    {
+      g_cancellable_cancel (list_item->prepare_cancellable);
+      g_clear_object (&list_item->prepare_cancellable);
+    }
+
+  g_signal_emit (self, signals[UNBIND], 0, list_item);
+
+  if (list_item->prepared_data)
+    {
+      if (list_item->prepared_data_destroy)
+        list_item->prepared_data_destroy (list_item->prepared_data);
+      list_item->prepared_data = NULL;
+      list_item->prepared_data_destroy = NULL;
+    }
+}
+
 static void
 gtk_signal_list_item_factory_setup (GtkListItemFactory *factory,
                                     GtkListItemWidget  *widget,
                                     GtkListItem        *list_item)
 {
+  GtkSignalListItemFactory *self = GTK_SIGNAL_LIST_ITEM_FACTORY (factory);
+
   g_signal_emit (factory, signals[SETUP], 0, list_item);
 
   GTK_LIST_ITEM_FACTORY_CLASS (gtk_signal_list_item_factory_parent_class)->setup (factory, widget, list_item);
 
   if (gtk_list_item_get_item (list_item))
-    g_signal_emit (factory, signals[BIND], 0, list_item);
+    gtk_signal_list_item_factory_bind (self, list_item);
 }
 
 static void                  
@@ -124,13 +341,15 @@ gtk_signal_list_item_factory_update (GtkListItemFactory *factory,
                                      gpointer            item,
                                      gboolean            selected)
 {
+  GtkSignalListItemFactory *self = GTK_SIGNAL_LIST_ITEM_FACTORY (factory);
+
   if (gtk_list_item_get_item (list_item))
-    g_signal_emit (factory, signals[UNBIND], 0, list_item);
+    gtk_signal_list_item_factory_unbind (self, list_item);
 
   GTK_LIST_ITEM_FACTORY_CLASS (gtk_signal_list_item_factory_parent_class)->update (factory, widget, list_item, position, item, selected);
 
   if (item)
-    g_signal_emit (factory, signals[BIND], 0, list_item);
+    gtk_signal_list_item_factory_bind (self, list_item);
 }
 
 static void
@@ -138,19 +357,34 @@ gtk_signal_list_item_factory_teardown (GtkListItemFactory *factory,
                                        GtkListItemWidget  *widget,
                                        GtkListItem        *list_item)
 {
+  GtkSignalListItemFactory *self = GTK_SIGNAL_LIST_ITEM_FACTORY (factory);
+
   if (gtk_list_item_get_item (list_item))
-    g_signal_emit (factory, signals[UNBIND], 0, list_item);
+    gtk_signal_list_item_factory_unbind (self, list_item);
 
   GTK_LIST_ITEM_FACTORY_CLASS (gtk_signal_list_item_factory_parent_class)->teardown (factory, widget, list_item);
 
   g_signal_emit (factory, signals[TEARDOWN], 0, list_item);
 }
 
+static void
+gtk_signal_list_item_factory_finalize (GObject *object)
+{
+  GtkSignalListItemFactory *self = GTK_SIGNAL_LIST_ITEM_FACTORY (object);
+
+  g_clear_pointer (&self->prepare, gtk_list_item_prepare_unref);
+
+  G_OBJECT_CLASS (gtk_signal_list_item_factory_parent_class)->finalize (object);
+}
+
 static void
 gtk_signal_list_item_factory_class_init (GtkSignalListItemFactoryClass *klass)
 {
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
   GtkListItemFactoryClass *factory_class = GTK_LIST_ITEM_FACTORY_CLASS (klass);
 
+  gobject_class->finalize = gtk_signal_list_item_factory_finalize;
+
   factory_class->setup = gtk_signal_list_item_factory_setup;
   factory_class->teardown = gtk_signal_list_item_factory_teardown;
   factory_class->update = gtk_signal_list_item_factory_update;
@@ -274,3 +508,75 @@ gtk_signal_list_item_factory_new (void)
   return g_object_new (GTK_TYPE_SIGNAL_LIST_ITEM_FACTORY, NULL);
 }
 
+
+/**
+ * gtk_signal_list_item_factory_set_prepare_func:
+ * @self: a #GtkSignalListItemFactory
+ * @prepare_func: (nullable): function to prepare the data for binding
+ *     an item on a worker thread or %NULL to bind items synchronously
+ * @data_destroy: (nullable): function to free the data returned
+ *     by @prepare_func
+ * @user_data: user data passed to @prepare_func
+ * @user_destroy: destroy notifier for @user_data
+ *
+ * Sets a function that prepares the data for binding items on
+ * a worker thread.
+ *
+ * Listitems are bound as usual while @prepare_func runs. When the data
+ * is ready, they are unbound and bound again, and the data can be
+ * queried with gtk_signal_list_item_factory_get_prepared_data() in the
+ * #GtkSignalListItemFactory::bind handler.
+ *
+ * Changing the prepare function only affects items bound afterwards.
+ * Tasks that are already running keep using the previous function and
+ * its @user_data, which is only destroyed once they are done.
+ *
+ * Since: 4.2
+ **/
+void
+gtk_signal_list_item_factory_set_prepare_func (GtkSignalListItemFactory *self,
+                                               GtkListItemPrepareFunc    prepare_func,
+                                               GDestroyNotify            data_destroy,
+                                               gpointer                  user_data,
+                                               GDestroyNotify            user_destroy)
+{
+  g_return_if_fail (GTK_IS_SIGNAL_LIST_ITEM_FACTORY (self));
+  g_return_if_fail (prepare_func || (data_destroy == NULL && user_data == NULL && user_destroy == NULL));
+
+  g_clear_pointer (&self->prepare, gtk_list_item_prepare_unref);
+
+  if (prepare_func == NULL)
+    return;
+
+  self->prepare = g_slice_new (GtkListItemPrepare);
+  self->prepare->ref_count = 1;
+  self->prepare->func = prepare_func;
+  self->prepare->data_destroy = data_destroy;
+  self->prepare->user_data = user_data;
+  self->prepare->user_destroy = user_destroy;
+}
+
+/**
+ * gtk_signal_list_item_factory_get_prepared_data:
+ * @self: a #GtkSignalListItemFactory
+ * @list_item: a #GtkListItem created by @self
+ *
+ * Gets the data returned by the prepare function for the item
+ * @list_item is currently bound to.
+ *
+ * See gtk_signal_list_item_factory_set_prepare_func().
+ *
+ * Returns: (nullable) (transfer none): the prepared data or %NULL
+ *     if it is not available yet
+ *
+ * Since: 4.2
+ **/
+gpointer
+gtk_signal_list_item_factory_get_prepared_data (GtkSignalListItemFactory *self,
+                                                GtkListItem              *list_item)
+{
+  g_return_val_if_fail (GTK_IS_SIGNAL_LIST_ITEM_FACTORY (self), NULL);
+  g_return_val_if_fail (GTK_IS_LIST_ITEM (list_item), NULL);
+
+  return list_item->prepared_data;
+}
@@ -50,6 +50,36 @@ GType                   gtk_signal_list_item_factory_get_type   (void) G_GNUC_CO
 GDK_AVAILABLE_IN_ALL
 GtkListItemFactory *    gtk_signal_list_item_factory_new        (void);
 
+/**
+ * GtkListItemPrepareFunc:
+ * @item: (type GObject): The item to prepare data for
+ * @cancellable: (nullable): a #GCancellable that is cancelled when the
+ *     data is no longer needed
+ * @user_data: The data passed to gtk_signal_list_item_factory_set_prepare_func()
+ *
+ * User function that is called on a worker thread to prepare the data
+ * needed to bind @item.
+ *
+ * The function must not touch any widgets.
+ *
+ * Returns: (nullable) (transfer full): the prepared data or %NULL
+ */
+typedef gpointer (* GtkListItemPrepareFunc) (gpointer      item,
+                                             GCancellable *cancellable,
+                                             gpointer      user_data);
+
+GDK_AVAILABLE_IN_4_2
+void                    gtk_signal_list_item_factory_set_prepare_func
+                                                                (GtkSignalListItemFactory *self,
+                                                                 GtkListItemPrepareFunc    prepare_func,
+                                                                 GDestroyNotify            data_destroy,
+                                                                 gpointer                  user_data,
+                                                                 GDestroyNotify            user_destroy);
+GDK_AVAILABLE_IN_4_2
+gpointer                gtk_signal_list_item_factory_get_prepared_data
+                                                                (GtkSignalListItemFactory *self,
+                                                                 GtkListItem              *list_item);
+
 
 G_END_DECLS
 
@@ -23,6 +23,7 @@
 
 #include "gtkbitset.h"
 #include "gtkintl.h"
+#include "gtkprefetchableprivate.h"
 #include "gtkselectionmodel.h"
 
 /**
@@ -167,11 +168,29 @@ gtk_single_selection_selection_model_init (GtkSelectionModelInterface *iface)
   iface->unselect_item = gtk_single_selection_unselect_item; 
 }
 
+static void
+gtk_single_selection_prefetch (GtkPrefetchable *prefetchable,
+                               guint            position,
+                               guint            n_items)
+{
+  GtkSingleSelection *self = GTK_SINGLE_SELECTION (prefetchable);
+
+  gtk_prefetchable_forward (self->model, position, n_items);
+}
+
+static void
+gtk_single_selection_prefetchable_init (GtkPrefetchableInterface *iface)
+{
+  iface->prefetch = gtk_single_selection_prefetch;
+}
+
 G_DEFINE_TYPE_EXTENDED (GtkSingleSelection, gtk_single_selection, G_TYPE_OBJECT, 0,
                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL,
                                                gtk_single_selection_list_model_init)
                         G_IMPLEMENT_INTERFACE (GTK_TYPE_SELECTION_MODEL,
-                                               gtk_single_selection_selection_model_init))
+                                               gtk_single_selection_selection_model_init)
+                        G_IMPLEMENT_INTERFACE (GTK_TYPE_PREFETCHABLE,
+                                               gtk_single_selection_prefetchable_init))
 
 static void
 gtk_single_selection_items_changed_cb (GListModel         *model,
@@ -22,6 +22,7 @@
 #include "gtkslicelistmodel.h"
 
 #include "gtkintl.h"
+#include "gtkprefetchableprivate.h"
 #include "gtkprivate.h"
 
 /**
@@ -114,8 +115,30 @@ gtk_slice_list_model_model_init (GListModelInterface *iface)
   iface->get_item = gtk_slice_list_model_get_item;
 }
 
+static void
+gtk_slice_list_model_prefetch (GtkPrefetchable *prefetchable,
+                               guint            position,
+                               guint            n_items)
+{
+  GtkSliceListModel *self = GTK_SLICE_LIST_MODEL (prefetchable);
+
+  if (position >= self->size)
+    return;
+
+  gtk_prefetchable_forward (self->model,
+                            self->offset + position,
+                            MIN (n_items, self->size - position));
+}
+
+static void
+gtk_slice_list_model_prefetchable_init (GtkPrefetchableInterface *iface)
+{
+  iface->prefetch = gtk_slice_list_model_prefetch;
+}
+
 G_DEFINE_TYPE_WITH_CODE (GtkSliceListModel, gtk_slice_list_model, G_TYPE_OBJECT,
-                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_slice_list_model_model_init))
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_slice_list_model_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_PREFETCHABLE, gtk_slice_list_model_prefetchable_init))
 
 static void
 gtk_slice_list_model_items_changed_cb (GListModel        *model,
@@ -86,7 +86,11 @@ gtk_sort_keys_is_compatible (GtkSortKeys *self,
   if (self == other)
     return TRUE;
 
-  return self->klass->is_compatible (self, other);
+  /* Keys that wrap other keys know when they are compatible
+   * with the keys they wrap, so ask both of them.
+   */
+  return self->klass->is_compatible (self, other) ||
+         other->klass->is_compatible (other, self);
 }
 
 gboolean
@@ -95,6 +99,163 @@ gtk_sort_keys_needs_clear_key (GtkSortKeys *self)
   return self->klass->clear_key != NULL;
 }
 
+/*<private>
+ * gtk_sort_keys_is_thread_safe:
+ * @self: a #GtkSortKeys
+ *
+ * Checks if keys created with @self can be compared from a
+ * different thread than the one they were created in.
+ *
+ * This is the case when keys are plain memory and the compare
+ * function does not need to look at the items or the sorter.
+ *
+ * Returns: %TRUE if the key compare function is thread-safe
+ **/
+gboolean
+gtk_sort_keys_is_thread_safe (GtkSortKeys *self)
+{
+  return self->thread_safe;
+}
+
+/*<private>
+ * gtk_sort_keys_can_convert:
+ * @self: a #GtkSortKeys
+ * @other: the #GtkSortKeys that created the existing keys
+ *
+ * Checks if keys created with @other can be partially reused when
+ * creating keys with @self. This is the case when a sorter combining
+ * other sorters only adds or removes some of them.
+ *
+ * If this function returns %TRUE, gtk_sort_keys_convert_key() is faster
+ * than clearing the old keys and initializing new ones.
+ *
+ * Returns: %TRUE if converting keys is worth it
+ **/
+gboolean
+gtk_sort_keys_can_convert (GtkSortKeys *self,
+                           GtkSortKeys *other)
+{
+  if (gtk_sort_keys_is_compatible (self, other))
+    return TRUE;
+
+  /* either of the two keys may know how to convert */
+  if (self->klass->can_convert)
+    return self->klass->can_convert (self, other);
+  else if (other->klass->can_convert)
+    return other->klass->can_convert (self, other);
+  else
+    return FALSE;
+}
+
+/*<private>
+ * gtk_sort_keys_convert_needs_item:
+ * @self: a #GtkSortKeys
+ * @other: the #GtkSortKeys that created the existing keys
+ *
+ * Checks if gtk_sort_keys_convert_key() needs to look at the item
+ * to convert keys created by @other. If it doesn't, %NULL may be
+ * passed as the item, so callers can avoid looking up the items.
+ *
+ * Returns: %TRUE if converting keys needs the items
+ **/
+gboolean
+gtk_sort_keys_convert_needs_item (GtkSortKeys *self,
+                                  GtkSortKeys *other)
+{
+  const GtkSortKeysClass *klass;
+
+  if (gtk_sort_keys_is_compatible (self, other))
+    return FALSE;
+
+  if (self->klass->convert_key)
+    klass = self->klass;
+  else if (other->klass->convert_key)
+    klass = other->klass;
+  else
+    return TRUE;
+
+  if (klass->convert_needs_item == NULL)
+    return TRUE;
+
+  return klass->convert_needs_item (self, other);
+}
+
+/*<private>
+ * gtk_sort_keys_convert_key:
+ * @self: a #GtkSortKeys
+ * @item: (nullable): the item to create the key for, may only be %NULL
+ *     if gtk_sort_keys_convert_needs_item() returns %FALSE
+ * @key_memory: the memory to initialize
+ * @other: the #GtkSortKeys that created @other_key_memory
+ * @other_key_memory: the key that was created for @item by @other
+ *
+ * Initializes @key_memory like gtk_sort_keys_init_key(), but reuses
+ * as much as possible from @other_key_memory.
+ *
+ * Afterwards, @other_key_memory is considered cleared and must not be
+ * used anymore.
+ **/
+void
+gtk_sort_keys_convert_key (GtkSortKeys *self,
+                           gpointer     item,
+                           gpointer     key_memory,
+                           GtkSortKeys *other,
+                           gpointer     other_key_memory)
+{
+  if (gtk_sort_keys_is_compatible (self, other))
+    {
+      memcpy (key_memory, other_key_memory, self->key_size);
+    }
+  else if (self->klass->convert_key)
+    {
+      self->klass->convert_key (self, item, key_memory, other, other_key_memory);
+    }
+  else if (other->klass->convert_key)
+    {
+      other->klass->convert_key (self, item, key_memory, other, other_key_memory);
+    }
+  else
+    {
+      gtk_sort_keys_clear_key (other, other_key_memory);
+      gtk_sort_keys_init_key (self, item, key_memory);
+    }
+}
+
+/*<private>
+ * gtk_sort_keys_has_key_prefix:
+ * @self: a #GtkSortKeys
+ *
+ * Checks if @self can map keys to a number with
+ * gtk_sort_keys_get_key_prefix().
+ *
+ * Keys with a smaller prefix always sort before keys with a larger
+ * one, so sorting by prefix only needs the compare function to break
+ * ties. This allows using radix sort instead of comparisons.
+ *
+ * Returns: %TRUE if gtk_sort_keys_get_key_prefix() can be used
+ **/
+gboolean
+gtk_sort_keys_has_key_prefix (GtkSortKeys *self)
+{
+  return self->klass->get_key_prefix != NULL;
+}
+
+/*<private>
+ * gtk_sort_keys_has_exact_key_prefix:
+ * @self: a #GtkSortKeys
+ *
+ * Checks if the prefixes of keys fully describe their order, that is
+ * if keys with equal prefixes always compare equal. In that case,
+ * the compare function isn't needed when sorting by prefix.
+ *
+ * Returns: %TRUE if prefixes are exact
+ **/
+gboolean
+gtk_sort_keys_has_exact_key_prefix (GtkSortKeys *self)
+{
+  return gtk_sort_keys_has_key_prefix (self) && self->exact_prefix;
+}
+
 static void
 gtk_equal_sort_keys_free (GtkSortKeys *keys)
 {
@@ -143,8 +304,13 @@ static const GtkSortKeysClass GTK_EQUAL_SORT_KEYS_CLASS =
 GtkSortKeys *
 gtk_sort_keys_new_equal (void)
 {
-  return gtk_sort_keys_new (GtkSortKeys,
-                            &GTK_EQUAL_SORT_KEYS_CLASS,
-                            0, 1);
+  GtkSortKeys *result;
+
+  result = gtk_sort_keys_new (GtkSortKeys,
+                              &GTK_EQUAL_SORT_KEYS_CLASS,
+                              0, 1);
+  result->thread_safe = TRUE;
+
+  return result;
 }
 
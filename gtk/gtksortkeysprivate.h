@@ -32,6 +32,8 @@ struct _GtkSortKeys
 
   gsize key_size;
   gsize key_align; /* must be power of 2 */
+  gboolean thread_safe; /* key_compare may be called from any thread */
+  gboolean exact_prefix; /* keys with equal prefixes compare equal */
 };
 
 struct _GtkSortKeysClass
@@ -48,6 +50,25 @@ struct _GtkSortKeysClass
                                                                  gpointer                key_memory);
   void                  (* clear_key)                           (GtkSortKeys            *self,
                                                                  gpointer                key_memory);
+
+  /* optional, see gtk_sort_keys_convert_key().
+   * These are called for the class of either the new or the old keys. */
+  gboolean              (* can_convert)                         (GtkSortKeys            *self,
+                                                                 GtkSortKeys            *other);
+  void                  (* convert_key)                         (GtkSortKeys            *self,
+                                                                 gpointer                item,
+                                                                 gpointer                key_memory,
+                                                                 GtkSortKeys            *other,
+                                                                 gpointer                other_key_memory);
+
+  /* optional, see gtk_sort_keys_get_key_prefix() */
+  guint64               (* get_key_prefix)                      (GtkSortKeys            *self,
+                                                                 gconstpointer           key_memory);
+
+  /* optional, see gtk_sort_keys_convert_needs_item().
+   * Called for the class that implements convert_key. */
+  gboolean              (* convert_needs_item)                  (GtkSortKeys            *self,
+                                                                 GtkSortKeys            *other);
 };
 
 GtkSortKeys *           gtk_sort_keys_alloc                     (const GtkSortKeysClass *klass,
@@ -67,6 +88,18 @@ GCompareDataFunc        gtk_sort_keys_get_key_compare_func      (GtkSortKeys
 gboolean                gtk_sort_keys_is_compatible             (GtkSortKeys            *self,
                                                                  GtkSortKeys            *other);
 gboolean                gtk_sort_keys_needs_clear_key           (GtkSortKeys            *self);
+gboolean                gtk_sort_keys_is_thread_safe            (GtkSortKeys            *self);
+gboolean                gtk_sort_keys_can_convert               (GtkSortKeys            *self,
+                                                                 GtkSortKeys            *other);
+gboolean                gtk_sort_keys_convert_needs_item        (GtkSortKeys            *self,
+                                                                 GtkSortKeys            *other);
+void                    gtk_sort_keys_convert_key               (GtkSortKeys            *self,
+                                                                 gpointer                item,
+                                                                 gpointer                key_memory,
+                                                                 GtkSortKeys            *other,
+                                                                 gpointer                other_key_memory);
+gboolean                gtk_sort_keys_has_key_prefix            (GtkSortKeys            *self);
+gboolean                gtk_sort_keys_has_exact_key_prefix      (GtkSortKeys            *self);
 
 #define GTK_SORT_KEYS_ALIGN(_size,_align) (((_size) + (_align) - 1) & ~((_align) - 1))
 static inline int
@@ -85,6 +118,13 @@ gtk_sort_keys_init_key (GtkSortKeys *self,
   self->klass->init_key (self, item, key_memory);
 }
 
+static inline guint64
+gtk_sort_keys_get_key_prefix (GtkSortKeys   *self,
+                              gconstpointer  key_memory)
+{
+  return self->klass->get_key_prefix (self, key_memory);
+}
+
 static inline void
 gtk_sort_keys_clear_key (GtkSortKeys *self,
                          gpointer       key_memory)
@@ -23,6 +23,7 @@
 
 #include "gtkbitset.h"
 #include "gtkintl.h"
+#include "gtkprefetchableprivate.h"
 #include "gtkprivate.h"
 #include "gtksorterprivate.h"
 #include "timsort/gtktimsortprivate.h"
@@ -52,6 +53,29 @@
  */
 #define GTK_SORT_STEP_TIME_US (1000) /* 1 millisecond */
 
+/* The minimum number of items for which we sort in a thread
+ *
+ * Handing the sort to a thread has a fixed overhead and delays the
+ * result until the next main loop iteration, so for small models
+ * sorting right away is faster.
+ */
+#define GTK_SORT_THREADED_MIN_ITEMS (10 * 1000)
+
+/* Minimum number of items to sort by key prefix, see
+ * gtk_sort_keys_get_key_prefix(). For small lists, comparing
+ * is just as fast.
+ */
+#define GTK_SORT_PREFIX_MIN_ITEMS (1024)
+
+/* The maximum number of ::items-changed signals we emit for a resort
+ *
+ * Emitting a signal for every item that moved keeps the widgets for all
+ * the other items, but each signal has an overhead in the list widgets.
+ * When lots of items move, a single signal for the whole range is
+ * cheaper.
+ */
+#define GTK_SORT_MAX_CHANGES (16)
+
 /**
  * SECTION:gtksortlistmodel
  * @title: GtkSortListModel
@@ -65,6 +89,15 @@
  * sorting long lists doesn't block the UI. See
  * gtk_sort_list_model_set_incremental() for details.
  *
+ * Alternatively, the model can sort in worker threads. See
+ * gtk_sort_list_model_set_threaded() for details.
+ *
+ * When a single item of the sorted model is replaced, only that item
+ * is moved to its new position instead of sorting all items again.
+ * So if a property of an item changes in a way that affects sorting,
+ * it is a lot cheaper to emit #GListModel::items-changed for just
+ * that item than to emit #GtkSorter::changed.
+ *
  * #GtkSortListModel is a generic model and because of that it
  * cannot take advantage of any external knowledge when sorting.
  * If you run into performance issues with #GtkSortListModel, it
@@ -78,9 +111,27 @@ enum {
   PROP_MODEL,
   PROP_PENDING,
   PROP_SORTER,
+  PROP_THREADED,
   NUM_PROPERTIES
 };
 
+typedef struct _GtkSortListJob GtkSortListJob;
+
+struct _GtkSortListJob
+{
+  GCancellable *cancellable;
+  GtkSortKeys *sort_keys;
+  gsize runs[GTK_TIM_SORT_MAX_PENDING + 1]; /* runs at the time the job was started */
+
+  guint n_items;
+  gpointer *positions; /* copy of the positions array that gets sorted */
+
+  GMutex lock;
+  GCond cond;
+  gboolean done;
+  gboolean sorted;
+};
+
 struct _GtkSortListModel
 {
   GObject parent_instance;
@@ -88,9 +139,11 @@ struct _GtkSortListModel
   GListModel *model;
   GtkSorter *sorter;
   gboolean incremental;
+  gboolean threaded;
 
   GtkTimSort sort; /* ongoing sort operation */
   guint sort_cb; /* 0 or current ongoing sort callback */
+  GtkSortListJob *sort_job; /* NULL or current ongoing threaded sort */
 
   guint n_items;
   GtkSortKeys *sort_keys;
@@ -99,6 +152,16 @@ struct _GtkSortListModel
   GtkBitset *missing_keys;
 
   gpointer *positions;
+
+  /* While emitting multiple ::items-changed signals for a resort,
+   * the items in the range that is changing.
+   * See gtk_sort_list_model_emit_resort() and
+   * gtk_sort_list_model_finish_resort().
+   */
+  gpointer *resort_view;
+  guint resort_position;
+  guint resort_n_items; /* size of the range in positions */
+  guint resort_view_n_items; /* size of the range in resort_view */
 };
 
 struct _GtkSortListModelClass
@@ -140,6 +203,9 @@ gtk_sort_list_model_get_n_items (GListModel *list)
   if (self->model == NULL)
     return 0;
 
+  if (self->resort_view)
+    return self->n_items - self->resort_n_items + self->resort_view_n_items;
+
   return g_list_model_get_n_items (self->model);
 }
 
@@ -152,6 +218,16 @@ gtk_sort_list_model_get_item (GListModel *list,
   if (self->model == NULL)
     return NULL;
 
+  if (self->resort_view && position >= self->resort_position)
+    {
+      guint offset = position - self->resort_position;
+
+      if (offset < self->resort_view_n_items)
+        return g_list_model_get_item (self->model, pos_from_key (self, self->resort_view[offset]));
+
+      position = position - self->resort_view_n_items + self->resort_n_items;
+    }
+
   if (position >= self->n_items)
     return NULL;
 
@@ -169,19 +245,118 @@ gtk_sort_list_model_model_init (GListModelInterface *iface)
   iface->get_item = gtk_sort_list_model_get_item;
 }
 
+static void
+gtk_sort_list_model_prefetch (GtkPrefetchable *prefetchable,
+                              guint            position,
+                              guint            n_items)
+{
+  GtkSortListModel *self = GTK_SORT_LIST_MODEL (prefetchable);
+  guint i, pos, first, last;
+
+  if (self->model == NULL || position >= self->n_items)
+    return;
+
+  n_items = MIN (n_items, self->n_items - position);
+
+  if (self->positions == NULL || self->resort_view)
+    {
+      gtk_prefetchable_forward (self->model, position, n_items);
+      return;
+    }
+
+  /* The items are sorted, so they can be scattered all over the
+   * unsorted model. Forwarding every run of them on its own doesn't
+   * work, as each prefetch replaces the previous one, so forward the
+   * range containing all of them, but only if it isn't much larger
+   * than what was asked for. */
+  first = G_MAXUINT;
+  last = 0;
+  for (i = position; i < position + n_items; i++)
+    {
+      pos = pos_from_key (self, self->positions[i]);
+      first = MIN (first, pos);
+      last = MAX (last, pos);
+    }
+
+  if (last - first >= 2 * n_items)
+    return;
+
+  gtk_prefetchable_forward (self->model, first, last - first + 1);
+}
+
+static void
+gtk_sort_list_model_prefetchable_init (GtkPrefetchableInterface *iface)
+{
+  iface->prefetch = gtk_sort_list_model_prefetch;
+}
+
 G_DEFINE_TYPE_WITH_CODE (GtkSortListModel, gtk_sort_list_model, G_TYPE_OBJECT,
-                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_sort_list_model_model_init))
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, gtk_sort_list_model_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_PREFETCHABLE, gtk_sort_list_model_prefetchable_init))
 
 static gboolean
 gtk_sort_list_model_is_sorting (GtkSortListModel *self)
 {
-  return self->sort_cb != 0;
+  return self->sort_cb != 0 || self->sort_job != NULL;
+}
+
+static void
+gtk_sort_list_job_free (gpointer data)
+{
+  GtkSortListJob *job = data;
+
+  /* sort keys are not threadsafe, so they are released in the main thread */
+  g_assert (job->sort_keys == NULL);
+
+  g_object_unref (job->cancellable);
+  g_free (job->positions);
+  g_cond_clear (&job->cond);
+  g_mutex_clear (&job->lock);
+
+  g_slice_free (GtkSortListJob, job);
+}
+
+static void
+gtk_sort_list_job_wait (GtkSortListJob *job)
+{
+  g_mutex_lock (&job->lock);
+  while (!job->done)
+    g_cond_wait (&job->cond, &job->lock);
+  g_mutex_unlock (&job->lock);
+}
+
+static void
+gtk_sort_list_model_stop_sort_job (GtkSortListModel *self,
+                                   gsize            *runs)
+{
+  GtkSortListJob *job = self->sort_job;
+
+  g_assert (job != NULL);
+
+  /* The thread reads the keys, so we must not modify them before it has
+   * noticed the cancellation. It checks regularly, so this is fast.
+   */
+  g_cancellable_cancel (job->cancellable);
+  gtk_sort_list_job_wait (job);
+
+  /* positions haven't been touched, so the old runs are still valid */
+  if (runs)
+    memcpy (runs, job->runs, sizeof (job->runs));
+
+  self->sort_job = NULL;
 }
 
 static void
 gtk_sort_list_model_stop_sorting (GtkSortListModel *self,
                                   gsize            *runs)
 {
+  if (self->sort_job)
+    {
+      gtk_sort_list_model_stop_sort_job (self, runs);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+      return;
+    }
+
   if (self->sort_cb == 0)
     {
       if (runs)
@@ -274,6 +449,8 @@ gtk_sort_list_model_sort_cb (gpointer data)
   GtkSortListModel *self = data;
   guint pos, n_items;
 
+  gtk_sort_list_model_finish_resort (self);
+
   if (gtk_sort_list_model_sort_step (self, FALSE, &pos, &n_items))
     {
       if (n_items)
@@ -286,6 +463,251 @@ gtk_sort_list_model_sort_cb (gpointer data)
   return G_SOURCE_REMOVE;
 }
 
+typedef struct _GtkSortListMove GtkSortListMove;
+
+struct _GtkSortListMove
+{
+  gpointer key;
+  guint index;
+};
+
+static int
+compare_moves_by_key (gconstpointer a,
+                      gconstpointer b,
+                      gpointer      unused)
+{
+  const GtkSortListMove *ma = a;
+  const GtkSortListMove *mb = b;
+
+  if (ma->key < mb->key)
+    return -1;
+  else if (ma->key > mb->key)
+    return 1;
+  else
+    return 0;
+}
+
+static guint
+find_old_index (GtkSortListMove *moves,
+                guint            n_moves,
+                gpointer         key)
+{
+  guint min, max;
+
+  min = 0;
+  max = n_moves;
+  while (min < max)
+    {
+      guint mid = (min + max) / 2;
+
+      if (moves[mid].key < key)
+        min = mid + 1;
+      else
+        max = mid;
+    }
+
+  g_assert (min < n_moves && moves[min].key == key);
+
+  return moves[min].index;
+}
+
+/* Marks the items in the longest run of @new that kept its order
+ * from @old as stable, in both @new_stable and @old_stable.
+ */
+static void
+gtk_sort_list_find_stable (gpointer *old,
+                           gpointer *new,
+                           guint     n_items,
+                           gboolean *old_stable,
+                           gboolean *new_stable)
+{
+  GtkSortListMove *moves;
+  guint *old_index, *tails, *prev;
+  guint i, n_tails;
+
+  /* Find where every item used to be */
+  moves = g_new (GtkSortListMove, n_items);
+  for (i = 0; i < n_items; i++)
+    {
+      moves[i].key = old[i];
+      moves[i].index = i;
+    }
+  gtk_tim_sort (moves, n_items, sizeof (GtkSortListMove), compare_moves_by_key, NULL);
+
+  old_index = g_new (guint, n_items);
+  for (i = 0; i < n_items; i++)
+    old_index[i] = find_old_index (moves, n_items, new[i]);
+  g_free (moves);
+
+  /* Longest increasing subsequence of old indexes.
+   * tails[k] is the item ending the best subsequence of length k + 1
+   */
+  tails = g_new (guint, n_items);
+  prev = g_new (guint, n_items);
+  n_tails = 0;
+  for (i = 0; i < n_items; i++)
+    {
+      guint min = 0, max = n_tails;
+
+      while (min < max)
+        {
+          guint mid = (min + max) / 2;
+
+          if (old_index[tails[mid]] < old_index[i])
+            min = mid + 1;
+          else
+            max = mid;
+        }
+
+      prev[i] = min > 0 ? tails[min - 1] : G_MAXUINT;
+      tails[min] = i;
+      if (min == n_tails)
+        n_tails++;
+    }
+
+  memset (old_stable, 0, sizeof (gboolean) * n_items);
+  memset (new_stable, 0, sizeof (gboolean) * n_items);
+  for (i = n_tails > 0 ? tails[n_tails - 1] : G_MAXUINT; i != G_MAXUINT; i = prev[i])
+    {
+      new_stable[i] = TRUE;
+      old_stable[old_index[i]] = TRUE;
+    }
+
+  g_free (prev);
+  g_free (tails);
+  g_free (old_index);
+}
+
+/* Signal handlers may change the model while we are emitting the
+ * signals for a resort. Before doing so, this function makes the model
+ * consistent again by emitting a single signal for the rest of the
+ * resort range. The resort notices this and stops emitting.
+ */
+static void
+gtk_sort_list_model_finish_resort (GtkSortListModel *self)
+{
+  guint position, removed, added;
+
+  if (self->resort_view == NULL)
+    return;
+
+  position = self->resort_position;
+  removed = self->resort_view_n_items;
+  added = self->resort_n_items;
+  self->resort_view = NULL;
+
+  g_list_model_items_changed (G_LIST_MODEL (self), position, removed, added);
+}
+
+/* Emits ::items-changed after the items in the range from @position to
+ * @position + @n_items were resorted. @old are the positions in that
+ * range before the resort.
+ *
+ * Instead of changing the whole range, items that kept their relative
+ * order are left alone, so list widgets can keep their rows. Only the
+ * items that moved are removed and added again.
+ */
+static void
+gtk_sort_list_model_emit_resort (GtkSortListModel *self,
+                                 gpointer         *old,
+                                 guint             position,
+                                 guint             n_items)
+{
+  gpointer *new = self->positions + position;
+  gpointer *view;
+  gboolean *old_stable, *new_stable;
+  struct {
+    guint old_index;
+    guint new_index;
+    guint removed;
+    guint added;
+  } changes[GTK_SORT_MAX_CHANGES];
+  guint i, j, n_changes;
+
+  if (n_items == 0)
+    return;
+
+  old_stable = g_new (gboolean, n_items);
+  new_stable = g_new (gboolean, n_items);
+  gtk_sort_list_find_stable (old, new, n_items, old_stable, new_stable);
+
+  /* Stable items are in the same order in both, so everything between
+   * two of them is a change.
+   */
+  n_changes = 0;
+  i = j = 0;
+  while (i < n_items || j < n_items)
+    {
+      guint removed, added;
+
+      /* stable items or items that happen to end up in the same place */
+      if (i < n_items && j < n_items && old[i] == new[j])
+        {
+          i++;
+          j++;
+          continue;
+        }
+
+      for (removed = 0; i + removed < n_items && !old_stable[i + removed]; removed++);
+      for (added = 0; j + added < n_items && !new_stable[j + added]; added++);
+      while (removed > 0 && added > 0 && old[i + removed - 1] == new[j + added - 1])
+        {
+          removed--;
+          added--;
+        }
+
+      if (n_changes == GTK_SORT_MAX_CHANGES)
+        break;
+
+      changes[n_changes].old_index = i;
+      changes[n_changes].new_index = j;
+      changes[n_changes].removed = removed;
+      changes[n_changes].added = added;
+      n_changes++;
+
+      i += removed;
+      j += added;
+    }
+
+  g_free (old_stable);
+  g_free (new_stable);
+
+  if (i < n_items || j < n_items)
+    {
+      /* too many changes */
+      g_list_model_items_changed (G_LIST_MODEL (self), position, n_items, n_items);
+      return;
+    }
+
+  /* During every signal, the range contains the new items up to the
+   * change and the old items after it.
+   */
+  view = g_new (gpointer, 2 * n_items);
+  self->resort_position = position;
+  self->resort_n_items = n_items;
+  for (i = 0; i < n_changes; i++)
+    {
+      guint new_end = changes[i].new_index + changes[i].added;
+      guint old_end = changes[i].old_index + changes[i].removed;
+
+      memcpy (view, new, sizeof (gpointer) * new_end);
+      memcpy (view + new_end, old + old_end, sizeof (gpointer) * (n_items - old_end));
+      self->resort_view = view;
+      self->resort_view_n_items = new_end + n_items - old_end;
+
+      g_list_model_items_changed (G_LIST_MODEL (self),
+                                  position + changes[i].new_index,
+                                  changes[i].removed,
+                                  changes[i].added);
+
+      /* A handler changed the model, see gtk_sort_list_model_finish_resort() */
+      if (self->resort_view != view)
+        break;
+    }
+  self->resort_view = NULL;
+  g_free (view);
+}
+
 static int
 sort_func (gconstpointer a,
            gconstpointer b,
@@ -302,11 +724,299 @@ sort_func (gconstpointer a,
   return *sa < *sb ? -1 : 1;
 }
 
+/* Copies @positions into place and returns the range that changed.
+ * If @out_old is given, it is set to a copy of the old positions
+ * in that range.
+ */
+static void
+gtk_sort_list_model_apply_positions (GtkSortListModel *self,
+                                     gpointer         *positions,
+                                     guint            *out_position,
+                                     guint            *out_n_items,
+                                     gpointer        **out_old)
+{
+  guint start, end;
+
+  for (start = 0; start < self->n_items; start++)
+    {
+      if (self->positions[start] != positions[start])
+        break;
+    }
+  for (end = self->n_items; end > start; end--)
+    {
+      if (self->positions[end - 1] != positions[end - 1])
+        break;
+    }
+
+  if (out_old)
+    *out_old = g_memdup (self->positions + start, sizeof (gpointer) * (end - start));
+
+  memcpy (self->positions + start, positions + start, sizeof (gpointer) * (end - start));
+
+  *out_position = start;
+  *out_n_items = end - start;
+}
+
+static void
+gtk_sort_list_model_apply_sort_job (GtkSortListModel *self,
+                                    GtkSortListJob   *job,
+                                    guint            *out_position,
+                                    guint            *out_n_items,
+                                    gpointer        **out_old)
+{
+  g_assert (job->n_items == self->n_items);
+
+  gtk_sort_list_model_apply_positions (self, job->positions, out_position, out_n_items, out_old);
+}
+
+static void
+gtk_sort_list_model_sort_thread (GTask        *task,
+                                 gpointer      source_object,
+                                 gpointer      task_data,
+                                 GCancellable *cancellable)
+{
+  GtkSortListJob *job = task_data;
+  gboolean sorted;
+
+  sorted = gtk_tim_sort_parallel (job->positions,
+                                  job->n_items,
+                                  sizeof (gpointer),
+                                  sort_func,
+                                  job->sort_keys,
+                                  g_get_num_processors (),
+                                  cancellable);
+
+  g_mutex_lock (&job->lock);
+  job->sorted = sorted;
+  job->done = TRUE;
+  g_cond_signal (&job->cond);
+  g_mutex_unlock (&job->lock);
+
+  g_task_return_boolean (task, sorted);
+}
+
+static void
+gtk_sort_list_model_sort_thread_done (GObject      *source,
+                                      GAsyncResult *result,
+                                      gpointer      unused)
+{
+  GtkSortListModel *self = GTK_SORT_LIST_MODEL (source);
+  GtkSortListJob *job = g_task_get_task_data (G_TASK (result));
+  gpointer *old_positions;
+  guint pos, n_items;
+
+  g_clear_pointer (&job->sort_keys, gtk_sort_keys_unref);
+
+  /* The job was stopped or finished synchronously already */
+  if (self->sort_job != job)
+    return;
+
+  self->sort_job = NULL;
+
+  gtk_sort_list_model_finish_resort (self);
+
+  gtk_sort_list_model_apply_sort_job (self, job, &pos, &n_items, &old_positions);
+  gtk_sort_list_model_emit_resort (self, old_positions, pos, n_items);
+  g_free (old_positions);
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+}
+
+static gboolean
+gtk_sort_list_model_should_sort_threaded (GtkSortListModel *self)
+{
+  return self->threaded &&
+         self->n_items >= GTK_SORT_THREADED_MIN_ITEMS &&
+         gtk_sort_keys_is_thread_safe (self->sort_keys);
+}
+
+static void
+gtk_sort_list_model_create_missing_keys (GtkSortListModel *self)
+{
+  GtkBitsetIter iter;
+  guint pos;
+
+  if (gtk_bitset_is_empty (self->missing_keys))
+    return;
+
+  for (gtk_bitset_iter_init_first (&iter, self->missing_keys, &pos);
+       gtk_bitset_iter_is_valid (&iter);
+       gtk_bitset_iter_next (&iter, &pos))
+    {
+      gpointer item = g_list_model_get_item (self->model, pos);
+      gtk_sort_keys_init_key (self->sort_keys, item, key_from_pos (self, pos));
+      g_object_unref (item);
+    }
+  gtk_bitset_remove_all (self->missing_keys);
+}
+
+static void
+gtk_sort_list_model_start_sort_job (GtkSortListModel *self,
+                                    gsize            *runs)
+{
+  GtkSortListJob *job;
+  GTask *task;
+
+  g_assert (self->sort_job == NULL);
+
+  /* Creating keys needs the items, so that has to happen here */
+  gtk_sort_list_model_create_missing_keys (self);
+
+  job = g_slice_new0 (GtkSortListJob);
+  job->cancellable = g_cancellable_new ();
+  job->sort_keys = gtk_sort_keys_ref (self->sort_keys);
+  if (runs)
+    memcpy (job->runs, runs, sizeof (job->runs));
+  else
+    job->runs[0] = 0;
+  job->n_items = self->n_items;
+  job->positions = g_new (gpointer, self->n_items);
+  memcpy (job->positions, self->positions, sizeof (gpointer) * self->n_items);
+  g_mutex_init (&job->lock);
+  g_cond_init (&job->cond);
+
+  self->sort_job = job;
+
+  task = g_task_new (self, job->cancellable, gtk_sort_list_model_sort_thread_done, NULL);
+  g_task_set_source_tag (task, gtk_sort_list_model_start_sort_job);
+  g_task_set_task_data (task, job, gtk_sort_list_job_free);
+  g_task_run_in_thread (task, gtk_sort_list_model_sort_thread);
+  g_object_unref (task);
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+}
+
+typedef struct _GtkSortListPrefix GtkSortListPrefix;
+
+struct _GtkSortListPrefix
+{
+  guint64 prefix;
+  gpointer key;
+};
+
+/* A stable LSD radix sort, going over the prefix one byte at a time.
+ * Bytes that are the same for all items are skipped.
+ *
+ * Returns either @items or @tmp, whichever ends up containing the
+ * sorted items.
+ */
+static GtkSortListPrefix *
+gtk_sort_list_radix_sort (GtkSortListPrefix *items,
+                          GtkSortListPrefix *tmp,
+                          guint              n_items)
+{
+  guint counts[8][256] = { { 0, }, };
+  guint byte, bucket, offset, i;
+
+  for (i = 0; i < n_items; i++)
+    {
+      for (byte = 0; byte < 8; byte++)
+        counts[byte][(items[i].prefix >> (8 * byte)) & 0xFF]++;
+    }
+
+  for (byte = 0; byte < 8; byte++)
+    {
+      guint shift = 8 * byte;
+      GtkSortListPrefix *swap;
+
+      if (counts[byte][(items[0].prefix >> shift) & 0xFF] == n_items)
+        continue;
+
+      offset = 0;
+      for (bucket = 0; bucket < 256; bucket++)
+        {
+          guint count = counts[byte][bucket];
+          counts[byte][bucket] = offset;
+          offset += count;
+        }
+
+      for (i = 0; i < n_items; i++)
+        {
+          bucket = (items[i].prefix >> shift) & 0xFF;
+          tmp[counts[byte][bucket]++] = items[i];
+        }
+
+      swap = items;
+      items = tmp;
+      tmp = swap;
+    }
+
+  return items;
+}
+
+/* Sorts the items by the prefixes of their keys in one go, only
+ * comparing keys when prefixes are equal.
+ * This is only worth it when the positions aren't sorted already,
+ * because unlike timsort it can't take advantage of that.
+ *
+ * Returns: %TRUE if the items were sorted
+ */
+static gboolean
+gtk_sort_list_model_sort_by_prefix (GtkSortListModel *self,
+                                    guint            *out_position,
+                                    guint            *out_n_items)
+{
+  GtkSortListPrefix *prefixes, *sorted;
+  gpointer *positions;
+  guint i, start;
+
+  g_assert (!gtk_sort_list_model_is_sorting (self));
+
+  if (self->incremental ||
+      self->n_items < GTK_SORT_PREFIX_MIN_ITEMS ||
+      gtk_sort_list_model_should_sort_threaded (self) ||
+      !gtk_sort_keys_has_key_prefix (self->sort_keys))
+    return FALSE;
+
+  gtk_sort_list_model_create_missing_keys (self);
+
+  /* Going through the keys in order makes the stable radix sort
+   * break ties by key address, just like sort_func() does.
+   */
+  prefixes = g_new (GtkSortListPrefix, 2 * self->n_items);
+  for (i = 0; i < self->n_items; i++)
+    {
+      prefixes[i].key = key_from_pos (self, i);
+      prefixes[i].prefix = gtk_sort_keys_get_key_prefix (self->sort_keys, prefixes[i].key);
+    }
+
+  sorted = gtk_sort_list_radix_sort (prefixes, prefixes + self->n_items, self->n_items);
+
+  positions = g_new (gpointer, self->n_items);
+  for (i = 0; i < self->n_items; i++)
+    positions[i] = sorted[i].key;
+
+  if (!gtk_sort_keys_has_exact_key_prefix (self->sort_keys))
+    {
+      for (start = 0; start < self->n_items; start = i)
+        {
+          for (i = start + 1; i < self->n_items && sorted[i].prefix == sorted[start].prefix; i++)
+            ;
+
+          if (i - start > 1)
+            gtk_tim_sort (positions + start, i - start, sizeof (gpointer), sort_func, self->sort_keys);
+        }
+    }
+
+  g_free (prefixes);
+
+  gtk_sort_list_model_apply_positions (self, positions, out_position, out_n_items, NULL);
+  g_free (positions);
+
+  return TRUE;
+}
+
 static gboolean
 gtk_sort_list_model_start_sorting (GtkSortListModel *self,
                                    gsize            *runs)
 {
   g_assert (self->sort_cb == 0);
+  g_assert (self->sort_job == NULL);
+
+  if (gtk_sort_list_model_should_sort_threaded (self))
+    {
+      gtk_sort_list_model_start_sort_job (self, runs);
+      return TRUE;
+    }
 
   gtk_tim_sort_init (&self->sort,
                      self->positions,
@@ -332,6 +1042,17 @@ gtk_sort_list_model_finish_sorting (GtkSortListModel *self,
                                     guint            *pos,
                                     guint            *n_items)
 {
+  if (self->sort_job)
+    {
+      GtkSortListJob *job = self->sort_job;
+
+      gtk_sort_list_job_wait (job);
+      self->sort_job = NULL;
+      gtk_sort_list_model_apply_sort_job (self, job, pos, n_items, NULL);
+      g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_PENDING]);
+      return;
+    }
+
   gtk_tim_sort_set_max_merge_size (&self->sort, 0);
 
   gtk_sort_list_model_sort_step (self, TRUE, pos, n_items);
@@ -558,6 +1279,114 @@ gtk_sort_list_model_update_items (GtkSortListModel *self,
   *unmodified_end = end;
 }
 
+/* Finds the index of @key in the sorted positions, pretending that
+ * the item at @skip isn't there. Returns the index where @key would
+ * be inserted if it isn't in positions.
+ */
+static guint
+gtk_sort_list_model_search (GtkSortListModel *self,
+                            gpointer          key,
+                            guint             skip)
+{
+  guint min, max;
+
+  min = 0;
+  max = skip < self->n_items ? self->n_items - 1 : self->n_items;
+  while (min < max)
+    {
+      guint mid = (min + max) / 2;
+      guint i = mid < skip ? mid : mid + 1;
+      int cmp;
+
+      cmp = sort_func (&self->positions[i], &key, self->sort_keys);
+      if (cmp == 0)
+        return mid;
+      else if (cmp < 0)
+        min = mid + 1;
+      else
+        max = mid;
+    }
+
+  return min;
+}
+
+/* Handles an item that was replaced in the model without sorting
+ * everything: The item's key is recreated and the item moved to
+ * its new place with a binary search.
+ */
+static void
+gtk_sort_list_model_update_item (GtkSortListModel *self,
+                                 guint             position)
+{
+  gpointer key, item;
+  guint old_index, new_index;
+
+  g_assert (!gtk_sort_list_model_is_sorting (self));
+  g_assert (gtk_bitset_is_empty (self->missing_keys));
+
+  key = key_from_pos (self, position);
+  old_index = gtk_sort_list_model_search (self, key, G_MAXUINT);
+  if (old_index >= self->n_items || self->positions[old_index] != key)
+    {
+      /* Keys that look at the item, like the ones of custom sorters,
+       * may already compare differently, so we can't search for them.
+       */
+      for (old_index = 0; old_index < self->n_items; old_index++)
+        {
+          if (self->positions[old_index] == key)
+            break;
+        }
+      g_assert (old_index < self->n_items);
+    }
+
+  gtk_sort_keys_clear_key (self->sort_keys, key);
+  item = g_list_model_get_item (self->model, position);
+  gtk_sort_keys_init_key (self->sort_keys, item, key);
+  g_object_unref (item);
+
+  new_index = gtk_sort_list_model_search (self, key, old_index);
+
+  if (new_index == old_index)
+    {
+      g_list_model_items_changed (G_LIST_MODEL (self), old_index, 1, 1);
+      return;
+    }
+
+  /* Emit the removal and the addition separately so the items in
+   * between are left alone. In between the two, the item is
+   * not part of the model.
+   */
+  if (old_index < new_index)
+    {
+      memmove (self->positions + old_index,
+               self->positions + old_index + 1,
+               sizeof (gpointer) * (new_index - old_index));
+      self->resort_view = self->positions + old_index;
+      self->resort_position = old_index;
+    }
+  else
+    {
+      memmove (self->positions + new_index + 1,
+               self->positions + new_index,
+               sizeof (gpointer) * (old_index - new_index));
+      self->resort_view = self->positions + new_index + 1;
+      self->resort_position = new_index;
+    }
+  self->positions[new_index] = key;
+  self->resort_n_items = MAX (old_index, new_index) - MIN (old_index, new_index) + 1;
+  self->resort_view_n_items = self->resort_n_items - 1;
+
+  g_list_model_items_changed (G_LIST_MODEL (self), old_index, 1, 0);
+
+  /* A handler changed the model, see gtk_sort_list_model_finish_resort() */
+  if (self->resort_view == NULL)
+    return;
+
+  self->resort_view = NULL;
+
+  g_list_model_items_changed (G_LIST_MODEL (self), new_index, 0, 1);
+}
+
 static void
 gtk_sort_list_model_items_changed_cb (GListModel       *model,
                                       guint             position,
@@ -572,6 +1401,8 @@ gtk_sort_list_model_items_changed_cb (GListModel       *model,
   if (removed == 0 && added == 0)
     return;
 
+  gtk_sort_list_model_finish_resort (self);
+
   if (!gtk_sort_list_model_should_sort (self))
     {
       self->n_items = self->n_items - removed + added;
@@ -579,6 +1410,12 @@ gtk_sort_list_model_items_changed_cb (GListModel       *model,
       return;
     }
 
+  if (removed == 1 && added == 1 && !gtk_sort_list_model_is_sorting (self))
+    {
+      gtk_sort_list_model_update_item (self, position);
+      return;
+    }
+
   was_sorting = gtk_sort_list_model_is_sorting (self);
   gtk_sort_list_model_stop_sorting (self, runs);
 
@@ -640,6 +1477,10 @@ gtk_sort_list_model_set_property (GObject      *object,
       gtk_sort_list_model_set_sorter (self, g_value_get_object (value));
       break;
 
+    case PROP_THREADED:
+      gtk_sort_list_model_set_threaded (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -672,63 +1513,175 @@ gtk_sort_list_model_get_property (GObject     *object,
       g_value_set_object (value, self->sorter);
       break;
 
+    case PROP_THREADED:
+      g_value_set_boolean (value, self->threaded);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
     }
 }
 
+/* Makes the positions point into the new keys array */
+static void
+gtk_sort_list_model_update_positions (GtkSortListModel *self,
+                                      char             *old_keys,
+                                      gsize             old_key_size)
+{
+  guint i;
+
+  for (i = 0; i < self->n_items; i++)
+    self->positions[i] = key_from_pos (self, ((char *) self->positions[i] - old_keys) / old_key_size);
+}
+
+/* Replaces the keys with @new_keys, reusing as much as possible of
+ * the existing keys.
+ */
+static void
+gtk_sort_list_model_convert_keys (GtkSortListModel *self,
+                                  GtkSortKeys      *new_keys)
+{
+  GtkSortKeys *old_sort_keys = self->sort_keys;
+  char *old_keys = self->keys;
+  gsize old_key_size = self->key_size;
+  GtkBitsetIter iter;
+  GtkBitset *valid;
+  gboolean needs_item;
+  guint pos;
+
+  /* Looking up items is slow, so skip it if all parts of the keys
+   * can be reused */
+  needs_item = gtk_sort_keys_convert_needs_item (new_keys, old_sort_keys);
+
+  self->sort_keys = new_keys;
+  self->key_size = gtk_sort_keys_get_key_size (new_keys);
+  self->keys = g_malloc_n (self->n_items, self->key_size);
+
+  valid = gtk_bitset_new_range (0, self->n_items);
+  gtk_bitset_subtract (valid, self->missing_keys);
+  for (gtk_bitset_iter_init_first (&iter, valid, &pos);
+       gtk_bitset_iter_is_valid (&iter);
+       gtk_bitset_iter_next (&iter, &pos))
+    {
+      gpointer item = needs_item ? g_list_model_get_item (self->model, pos) : NULL;
+      gtk_sort_keys_convert_key (new_keys,
+                                 item,
+                                 key_from_pos (self, pos),
+                                 old_sort_keys,
+                                 old_keys + old_key_size * pos);
+      g_clear_object (&item);
+    }
+  gtk_bitset_unref (valid);
+
+  gtk_sort_list_model_update_positions (self, old_keys, old_key_size);
+
+  g_free (old_keys);
+  gtk_sort_keys_unref (old_sort_keys);
+}
+
+static void
+gtk_sort_list_model_reverse (GtkSortListModel *self)
+{
+  guint i;
+
+  for (i = 0; i < self->n_items / 2; i++)
+    {
+      gpointer tmp = self->positions[i];
+      self->positions[i] = self->positions[self->n_items - 1 - i];
+      self->positions[self->n_items - 1 - i] = tmp;
+    }
+}
+
 static void
 gtk_sort_list_model_sorter_changed_cb (GtkSorter        *sorter,
                                        int               change,
                                        GtkSortListModel *self)
 {
+  gpointer *old_positions = NULL;
+  gboolean reversed = FALSE;
+  gboolean unordered = FALSE;
   guint pos, n_items;
 
+  gtk_sort_list_model_finish_resort (self);
+
   if (gtk_sort_list_model_should_sort (self))
     {
+      gboolean was_sorted = self->sort_keys != NULL && !gtk_sort_list_model_is_sorting (self);
+
       gtk_sort_list_model_stop_sorting (self, NULL);
 
       if (self->sort_keys == NULL)
         {
           gtk_sort_list_model_create_items (self);
+          unordered = TRUE;
         }
       else
         {
           GtkSortKeys *new_keys = gtk_sorter_get_keys (sorter);
 
-          if (!gtk_sort_keys_is_compatible (new_keys, self->sort_keys))
+          if (gtk_sort_keys_is_compatible (new_keys, self->sort_keys))
+            {
+              gtk_sort_keys_unref (self->sort_keys);
+              self->sort_keys = new_keys;
+
+              /* Reversing a sorted list leaves only runs of items that
+               * compare equal in the wrong order, and sorting finds
+               * and reverses those in linear time.
+               */
+              if (change == GTK_SORTER_CHANGE_INVERTED && was_sorted && self->n_items > 1)
+                {
+                  gtk_sort_list_model_reverse (self);
+                  reversed = TRUE;
+                }
+            }
+          else if (gtk_sort_keys_can_convert (new_keys, self->sort_keys))
+            {
+              gtk_sort_list_model_convert_keys (self, new_keys);
+            }
+          else
             {
               char *old_keys = self->keys;
               gsize old_key_size = self->key_size;
-              guint i;
 
               gtk_sort_list_model_clear_keys (self);
               gtk_sort_list_model_create_keys (self);
-
-              for (i = 0; i < self->n_items; i++)
-                self->positions[i] = key_from_pos (self, ((char *) self->positions[i] - old_keys) / old_key_size);
+              gtk_sort_list_model_update_positions (self, old_keys, old_key_size);
+              unordered = TRUE;
 
               gtk_sort_keys_unref (new_keys);
             }
+        }
+
+      /* Remember the order for emitting only the items that moved */
+      if (!reversed && !self->incremental && !gtk_sort_list_model_should_sort_threaded (self))
+        old_positions = g_memdup (self->positions, sizeof (gpointer) * self->n_items);
+
+      if (!unordered || !gtk_sort_list_model_sort_by_prefix (self, &pos, &n_items))
+        {
+          if (gtk_sort_list_model_start_sorting (self, NULL))
+            pos = n_items = 0;
           else
-            {
-              gtk_sort_keys_unref (self->sort_keys);
-              self->sort_keys = new_keys;
-            }
+            gtk_sort_list_model_finish_sorting (self, &pos, &n_items);
         }
 
-      if (gtk_sort_list_model_start_sorting (self, NULL))
-        pos = n_items = 0;
-      else
-        gtk_sort_list_model_finish_sorting (self, &pos, &n_items);
+      if (reversed)
+        {
+          pos = 0;
+          n_items = self->n_items;
+        }
     }
   else
     {
       gtk_sort_list_model_clear_items (self, &pos, &n_items);
     }
 
-  if (n_items > 0)
+  if (old_positions)
+    {
+      gtk_sort_list_model_emit_resort (self, old_positions + pos, pos, n_items);
+      g_free (old_positions);
+    }
+  else if (n_items > 0)
     g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
 }
 
@@ -822,6 +1775,20 @@ gtk_sort_list_model_class_init (GtkSortListModelClass *class)
                             GTK_TYPE_SORTER,
                             GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
 
+  /**
+   * GtkSortListModel:threaded:
+   *
+   * If the model should sort items in worker threads
+   *
+   * Since: 4.2
+   */
+  properties[PROP_THREADED] =
+      g_param_spec_boolean ("threaded",
+                            P_("Threaded"),
+                            P_("Sort items in worker threads"),
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, NUM_PROPERTIES, properties);
 }
 
@@ -880,6 +1847,8 @@ gtk_sort_list_model_set_model (GtkSortListModel *self,
   if (self->model == model)
     return;
 
+  gtk_sort_list_model_finish_resort (self);
+
   removed = g_list_model_get_n_items (G_LIST_MODEL (self));
   gtk_sort_list_model_clear_model (self);
 
@@ -894,7 +1863,8 @@ gtk_sort_list_model_set_model (GtkSortListModel *self,
       if (gtk_sort_list_model_should_sort (self))
         {
           gtk_sort_list_model_create_items (self);
-          if (!gtk_sort_list_model_start_sorting (self, NULL))
+          if (!gtk_sort_list_model_sort_by_prefix (self, &ignore1, &ignore2) &&
+              !gtk_sort_list_model_start_sorting (self, NULL))
             gtk_sort_list_model_finish_sorting (self, &ignore1, &ignore2);
         }
     }
@@ -997,10 +1967,12 @@ gtk_sort_list_model_set_incremental (GtkSortListModel *self,
 
   self->incremental = incremental;
 
-  if (!incremental && gtk_sort_list_model_is_sorting (self))
+  if (!incremental && self->sort_cb != 0)
     {
       guint pos, n_items;
 
+      gtk_sort_list_model_finish_resort (self);
+
       gtk_sort_list_model_finish_sorting (self, &pos, &n_items);
       if (n_items)
         g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
@@ -1026,6 +1998,75 @@ gtk_sort_list_model_get_incremental (GtkSortListModel *self)
   return self->incremental;
 }
 
+/**
+ * gtk_sort_list_model_set_threaded:
+ * @self: a #GtkSortListModel
+ * @threaded: %TRUE to sort in worker threads
+ *
+ * Sets the sort model to sort in worker threads.
+ *
+ * When threaded sorting is enabled, the sortlistmodel will compute
+ * the sort keys for all items in the main thread, but then hand the
+ * actual sorting off to worker threads, using all available
+ * processors. Once the sort is done, the new order is applied with a
+ * single #GListModel::items-changed emission. Until then, items stay
+ * in their previous order.
+ *
+ * Threaded sorting is only possible if the sorter's keys can be
+ * compared without looking at the items, like the ones of
+ * #GtkStringSorter and #GtkNumericSorter. For other sorters and
+ * for small models, this setting has no effect.
+ *
+ * Threaded sorting takes precedence over incremental sorting.
+ *
+ * By default, threaded sorting is disabled.
+ *
+ * Since: 4.2
+ */
+void
+gtk_sort_list_model_set_threaded (GtkSortListModel *self,
+                                  gboolean          threaded)
+{
+  g_return_if_fail (GTK_IS_SORT_LIST_MODEL (self));
+
+  if (self->threaded == threaded)
+    return;
+
+  self->threaded = threaded;
+
+  if (!threaded && self->sort_job != NULL)
+    {
+      guint pos, n_items;
+
+      gtk_sort_list_model_finish_resort (self);
+
+      gtk_sort_list_model_finish_sorting (self, &pos, &n_items);
+      if (n_items)
+        g_list_model_items_changed (G_LIST_MODEL (self), pos, n_items, n_items);
+    }
+
+  g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_THREADED]);
+}
+
+/**
+ * gtk_sort_list_model_get_threaded:
+ * @self: a #GtkSortListModel
+ *
+ * Returns whether threaded sorting was enabled via
+ * gtk_sort_list_model_set_threaded().
+ *
+ * Returns: %TRUE if threaded sorting is enabled
+ *
+ * Since: 4.2
+ */
+gboolean
+gtk_sort_list_model_get_threaded (GtkSortListModel *self)
+{
+  g_return_val_if_fail (GTK_IS_SORT_LIST_MODEL (self), FALSE);
+
+  return self->threaded;
+}
+
 /**
  * gtk_sort_list_model_get_pending:
  * @self: a #GtkSortListModel
@@ -1045,7 +2086,8 @@ gtk_sort_list_model_get_incremental (GtkSortListModel *self)
  * ]|
  *
  * If no sort operation is ongoing - in particular when
- * #GtkSortListModel:incremental is %FALSE - this function returns 0.
+ * #GtkSortListModel:incremental and #GtkSortListModel:threaded
+ * are %FALSE - this function returns 0.
  *
  * Returns: a progress estimate of remaining items to sort
  **/
@@ -1054,6 +2096,10 @@ gtk_sort_list_model_get_pending (GtkSortListModel *self)
 {
   g_return_val_if_fail (GTK_IS_SORT_LIST_MODEL (self), FALSE);
 
+  /* We can't know how far the threads are, so everything is pending */
+  if (self->sort_job)
+    return self->n_items;
+
   if (self->sort_cb == 0)
     return 0;
 
@@ -21,9 +21,12 @@
 
 #include "gtkstringfilter.h"
 
+#include "gtkfilterprivate.h"
 #include "gtkintl.h"
 #include "gtktypebuiltins.h"
 
+#include <string.h>
+
 /**
  * SECTION:gtkstringfilter
  * @Title: GtkStringFilter
@@ -63,19 +66,50 @@ G_DEFINE_TYPE (GtkStringFilter, gtk_string_filter, GTK_TYPE_FILTER)
 
 static GParamSpec *properties[NUM_PROPERTIES] = { NULL, };
 
+/* Checks if @s only contains ASCII and computes its length
+ * while doing so.
+ */
+static gboolean
+string_is_ascii (const char *s,
+                 gsize      *len)
+{
+  const guchar *p;
+
+  for (p = (const guchar *) s; *p; p++)
+    {
+      if (*p >= 0x80)
+        return FALSE;
+    }
+
+  *len = p - (const guchar *) s;
+  return TRUE;
+}
+
 static char *
-gtk_string_filter_prepare (GtkStringFilter *self,
-                           const char      *s)
+gtk_string_filter_prepare_string (const char *s,
+                                  gboolean    ignore_case)
 {
   char *tmp;
   char *result;
+  gsize len;
 
   if (s == NULL || s[0] == '\0')
     return NULL;
 
+  /* Normalization doesn't change ASCII and casefolding
+   * just makes it lowercase.
+   */
+  if (string_is_ascii (s, &len))
+    {
+      if (ignore_case)
+        return g_ascii_strdown (s, len);
+      else
+        return g_strndup (s, len);
+    }
+
   tmp = g_utf8_normalize (s, -1, G_NORMALIZE_ALL);
 
-  if (!self->ignore_case)
+  if (!ignore_case)
     return tmp;
 
   result = g_utf8_casefold (tmp, -1);
@@ -84,61 +118,352 @@ gtk_string_filter_prepare (GtkStringFilter *self,
   return result;
 }
 
-/* This is necessary because code just looks at self->search otherwise
- * and that can be the empty string...
+static char *
+gtk_string_filter_prepare (GtkStringFilter *self,
+                           const char      *s)
+{
+  return gtk_string_filter_prepare_string (s, self->ignore_case);
+}
+
+static char *
+gtk_string_filter_prepare_item (GtkExpression *expression,
+                                gboolean       ignore_case,
+                                gpointer       item)
+{
+  GValue value = G_VALUE_INIT;
+  char *result;
+
+  if (expression == NULL ||
+      !gtk_expression_evaluate (expression, item, &value))
+    return NULL;
+
+  result = gtk_string_filter_prepare_string (g_value_get_string (&value), ignore_case);
+
+  g_value_unset (&value);
+
+  return result;
+}
+
+/* A prepared search string, set up for matching it against
+ * lots of strings.
+ *
+ * Substring searches use memchr() - which the C library vectorizes -
+ * to find candidates for the first byte and only compare the rest
+ * of the needle when the last byte matches, too.
+ * Strings that only contain ASCII can be matched without preparing
+ * them first, by comparing them case-insensitively.
  */
+typedef struct _GtkStringMatcher GtkStringMatcher;
+struct _GtkStringMatcher
+{
+  GtkStringFilterMatchMode match_mode;
+  gboolean ignore_case;
+  const char *needle; /* the prepared search, NULL to match everything */
+  gsize len;
+  gboolean ascii; /* needle only contains ASCII */
+};
+
+static void
+gtk_string_matcher_init (GtkStringMatcher         *self,
+                         GtkStringFilterMatchMode  match_mode,
+                         gboolean                  ignore_case,
+                         const char               *search_prepared)
+{
+  self->match_mode = match_mode;
+  self->ignore_case = ignore_case;
+  self->needle = search_prepared;
+  if (search_prepared == NULL)
+    {
+      self->len = 0;
+      self->ascii = FALSE;
+    }
+  else if (string_is_ascii (search_prepared, &self->len))
+    {
+      self->ascii = TRUE;
+    }
+  else
+    {
+      self->len = strlen (search_prepared);
+      self->ascii = FALSE;
+    }
+}
+
 static gboolean
-gtk_string_filter_has_search (GtkStringFilter *self)
+gtk_string_matcher_find (const GtkStringMatcher *self,
+                         const char             *s,
+                         gsize                   s_len)
 {
-  return self->search_prepared != NULL;
+  const char *p, *end;
+  char last;
+
+  if (s_len < self->len)
+    return FALSE;
+
+  if (self->len == 1)
+    return memchr (s, self->needle[0], s_len) != NULL;
+
+  last = self->needle[self->len - 1];
+  end = s + s_len - self->len + 1;
+  for (p = s; p < end; p++)
+    {
+      p = memchr (p, self->needle[0], end - p);
+      if (p == NULL)
+        return FALSE;
+
+      if (p[self->len - 1] == last &&
+          memcmp (p + 1, self->needle + 1, self->len - 2) == 0)
+        return TRUE;
+    }
+
+  return FALSE;
 }
 
+/* Like gtk_string_matcher_find(), but @s has not been made lowercase */
 static gboolean
-gtk_string_filter_match (GtkFilter *filter,
-                         gpointer   item)
+gtk_string_matcher_find_ascii_caseless (const GtkStringMatcher *self,
+                                        const char             *s,
+                                        gsize                   s_len)
+{
+  char first, first_upper;
+  gsize i, j;
+
+  if (s_len < self->len)
+    return FALSE;
+
+  first = self->needle[0];
+  first_upper = g_ascii_toupper (first);
+
+  for (i = 0; i <= s_len - self->len; i++)
+    {
+      if (s[i] != first && s[i] != first_upper)
+        continue;
+
+      for (j = 1; j < self->len; j++)
+        {
+          if (g_ascii_tolower (s[i + j]) != self->needle[j])
+            break;
+        }
+      if (j == self->len)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+gtk_string_matcher_match_prepared_len (const GtkStringMatcher *self,
+                                       const char             *prepared,
+                                       gsize                   len)
+{
+  switch (self->match_mode)
+    {
+    case GTK_STRING_FILTER_MATCH_MODE_EXACT:
+      return len == self->len && memcmp (prepared, self->needle, len) == 0;
+    case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
+      return gtk_string_matcher_find (self, prepared, len);
+    case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
+      return len >= self->len && memcmp (prepared, self->needle, self->len) == 0;
+    default:
+      g_assert_not_reached ();
+      return FALSE;
+    }
+}
+
+static gboolean
+gtk_string_matcher_match_prepared (const GtkStringMatcher *self,
+                                   const char             *prepared)
+{
+  if (self->needle == NULL)
+    return TRUE;
+
+  if (prepared == NULL)
+    return FALSE;
+
+  return gtk_string_matcher_match_prepared_len (self, prepared, strlen (prepared));
+}
+
+/* Matches a string that hasn't been prepared. ASCII strings are
+ * compared directly instead of preparing a copy.
+ */
+static gboolean
+gtk_string_matcher_match_string (const GtkStringMatcher *self,
+                                 const char             *s)
 {
-  GtkStringFilter *self = GTK_STRING_FILTER (filter);
-  GValue value = G_VALUE_INIT;
   char *prepared;
-  const char *s;
   gboolean result;
+  gsize len;
 
-  if (!gtk_string_filter_has_search (self))
+  if (self->needle == NULL)
     return TRUE;
 
-  if (self->expression == NULL ||
-      !gtk_expression_evaluate (self->expression, item, &value))
+  if (s == NULL || s[0] == '\0')
     return FALSE;
-  s = g_value_get_string (&value);
-  prepared = gtk_string_filter_prepare (self, s);
-  if (prepared == NULL)
+
+  if (!string_is_ascii (s, &len))
+    {
+      prepared = gtk_string_filter_prepare_string (s, self->ignore_case);
+      result = gtk_string_matcher_match_prepared (self, prepared);
+      g_free (prepared);
+      return result;
+    }
+
+  /* a prepared needle with non-ASCII bytes can't be found in ASCII */
+  if (!self->ascii)
     return FALSE;
 
+  if (!self->ignore_case)
+    return gtk_string_matcher_match_prepared_len (self, s, len);
+
   switch (self->match_mode)
     {
     case GTK_STRING_FILTER_MATCH_MODE_EXACT:
-      result = strcmp (prepared, self->search_prepared) == 0;
-      break;
+      return len == self->len && g_ascii_strncasecmp (s, self->needle, len) == 0;
     case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
-      result = strstr (prepared, self->search_prepared) != NULL;
-      break;
+      return gtk_string_matcher_find_ascii_caseless (self, s, len);
     case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
-      result = g_str_has_prefix (prepared, self->search_prepared);
-      break;
+      return len >= self->len && g_ascii_strncasecmp (s, self->needle, self->len) == 0;
     default:
       g_assert_not_reached ();
+      return FALSE;
     }
+}
 
-#if 0
-  g_print ("%s (%s) %s %s (%s)\n", s, prepared, result ? "==" : "!=", self->search, self->search_prepared);
-#endif
+/* This is necessary because code just looks at self->search otherwise
+ * and that can be the empty string...
+ */
+static gboolean
+gtk_string_filter_has_search (GtkStringFilter *self)
+{
+  return self->search_prepared != NULL;
+}
+
+static gboolean
+gtk_string_filter_match (GtkFilter *filter,
+                         gpointer   item)
+{
+  GtkStringFilter *self = GTK_STRING_FILTER (filter);
+  GtkStringMatcher matcher;
+  GValue value = G_VALUE_INIT;
+  gboolean result;
+
+  if (!gtk_string_filter_has_search (self))
+    return TRUE;
+
+  if (self->expression == NULL ||
+      !gtk_expression_evaluate (self->expression, item, &value))
+    return FALSE;
+
+  gtk_string_matcher_init (&matcher, self->match_mode, self->ignore_case, self->search_prepared);
+  result = gtk_string_matcher_match_string (&matcher, g_value_get_string (&value));
 
-  g_free (prepared);
   g_value_unset (&value);
 
   return result;
 }
 
+typedef struct _GtkStringFilterKeys GtkStringFilterKeys;
+struct _GtkStringFilterKeys
+{
+  GtkFilterKeys keys;
+
+  GtkExpression *expression;
+  gboolean ignore_case;
+  char *search_prepared;
+  GtkStringMatcher matcher;
+};
+
+static void
+gtk_string_filter_keys_free (GtkFilterKeys *keys)
+{
+  GtkStringFilterKeys *self = (GtkStringFilterKeys *) keys;
+
+  gtk_expression_unref (self->expression);
+  g_free (self->search_prepared);
+  g_slice_free (GtkStringFilterKeys, self);
+}
+
+static gboolean
+gtk_string_filter_keys_match (GtkFilterKeys *keys,
+                              gconstpointer  key_memory)
+{
+  GtkStringFilterKeys *self = (GtkStringFilterKeys *) keys;
+  const char *key = *(const char **) key_memory;
+
+  return gtk_string_matcher_match_prepared (&self->matcher, key);
+}
+
+static gboolean
+gtk_string_filter_keys_is_compatible (GtkFilterKeys *keys,
+                                      GtkFilterKeys *other);
+
+static void
+gtk_string_filter_keys_init_key (GtkFilterKeys *keys,
+                                 gpointer       item,
+                                 gpointer       key_memory)
+{
+  GtkStringFilterKeys *self = (GtkStringFilterKeys *) keys;
+  char **key = (char **) key_memory;
+
+  *key = gtk_string_filter_prepare_item (self->expression, self->ignore_case, item);
+}
+
+static void
+gtk_string_filter_keys_clear_key (GtkFilterKeys *keys,
+                                  gpointer       key_memory)
+{
+  char **key = (char **) key_memory;
+
+  g_free (*key);
+}
+
+static const GtkFilterKeysClass GTK_STRING_FILTER_KEYS_CLASS =
+{
+  gtk_string_filter_keys_free,
+  gtk_string_filter_keys_match,
+  gtk_string_filter_keys_is_compatible,
+  gtk_string_filter_keys_init_key,
+  gtk_string_filter_keys_clear_key,
+};
+
+/* The keys only depend on how strings are prepared, not on the
+ * search term or match mode, so keys survive typing.
+ */
+static gboolean
+gtk_string_filter_keys_is_compatible (GtkFilterKeys *keys,
+                                      GtkFilterKeys *other)
+{
+  GtkStringFilterKeys *self = (GtkStringFilterKeys *) keys;
+  GtkStringFilterKeys *compare = (GtkStringFilterKeys *) other;
+
+  if (other->klass != &GTK_STRING_FILTER_KEYS_CLASS)
+    return FALSE;
+
+  return self->expression == compare->expression &&
+         self->ignore_case == compare->ignore_case;
+}
+
+static GtkFilterKeys *
+gtk_string_filter_keys_new (GtkStringFilter *self)
+{
+  GtkStringFilterKeys *result;
+
+  if (self->expression == NULL)
+    return NULL;
+
+  result = gtk_filter_keys_new (GtkStringFilterKeys,
+                                &GTK_STRING_FILTER_KEYS_CLASS,
+                                sizeof (char *),
+                                sizeof (char *));
+
+  result->expression = gtk_expression_ref (self->expression);
+  result->ignore_case = self->ignore_case;
+  result->search_prepared = g_strdup (self->search_prepared);
+  gtk_string_matcher_init (&result->matcher, self->match_mode, self->ignore_case, result->search_prepared);
+  result->keys.thread_safe = TRUE;
+
+  return (GtkFilterKeys *) result;
+}
+
 static GtkFilterMatch
 gtk_string_filter_get_strictness (GtkFilter *filter)
 {
@@ -299,6 +624,8 @@ gtk_string_filter_init (GtkStringFilter *self)
 {
   self->ignore_case = TRUE;
   self->match_mode = GTK_STRING_FILTER_MATCH_MODE_SUBSTRING;
+
+  gtk_filter_set_keys (GTK_FILTER (self), gtk_string_filter_keys_new (self));
 }
 
 /**
@@ -356,19 +683,35 @@ gtk_string_filter_set_search (GtkStringFilter *self,
                               const char      *search)
 {
   GtkFilterChange change;
+  char *search_prepared;
 
   g_return_if_fail (GTK_IS_STRING_FILTER (self));
 
   if (g_strcmp0 (self->search, search) == 0)
     return;
 
-  if (search == NULL || search[0] == 0)
+  search_prepared = gtk_string_filter_prepare (self, search);
+
+  /* Compare the prepared strings, so that refining a search only
+   * rechecks the items that matched before.
+   */
+  if (search_prepared == NULL)
     change = GTK_FILTER_CHANGE_LESS_STRICT;
   else if (!gtk_string_filter_has_search (self))
     change = GTK_FILTER_CHANGE_MORE_STRICT;
-  else if (g_str_has_prefix (search, self->search))
+  else if (strcmp (search_prepared, self->search_prepared) == 0)
+    change = GTK_FILTER_CHANGE_MORE_STRICT;
+  else if (self->match_mode == GTK_STRING_FILTER_MATCH_MODE_EXACT)
+    change = GTK_FILTER_CHANGE_DIFFERENT;
+  else if (self->match_mode == GTK_STRING_FILTER_MATCH_MODE_SUBSTRING &&
+           strstr (search_prepared, self->search_prepared))
     change = GTK_FILTER_CHANGE_MORE_STRICT;
-  else if (g_str_has_prefix (self->search, search))
+  else if (self->match_mode == GTK_STRING_FILTER_MATCH_MODE_SUBSTRING &&
+           strstr (self->search_prepared, search_prepared))
+    change = GTK_FILTER_CHANGE_LESS_STRICT;
+  else if (g_str_has_prefix (search_prepared, self->search_prepared))
+    change = GTK_FILTER_CHANGE_MORE_STRICT;
+  else if (g_str_has_prefix (self->search_prepared, search_prepared))
     change = GTK_FILTER_CHANGE_LESS_STRICT;
   else
     change = GTK_FILTER_CHANGE_DIFFERENT;
@@ -377,9 +720,9 @@ gtk_string_filter_set_search (GtkStringFilter *self,
   g_free (self->search_prepared);
 
   self->search = g_strdup (search);
-  self->search_prepared = gtk_string_filter_prepare (self, search);
+  self->search_prepared = search_prepared;
 
-  gtk_filter_changed (GTK_FILTER (self), change);
+  gtk_filter_changed_with_keys (GTK_FILTER (self), change, gtk_string_filter_keys_new (self));
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SEARCH]);
 }
@@ -424,7 +767,9 @@ gtk_string_filter_set_expression (GtkStringFilter *self,
   self->expression = gtk_expression_ref (expression);
 
   if (gtk_string_filter_has_search (self))
-    gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_DIFFERENT);
+    gtk_filter_changed_with_keys (GTK_FILTER (self), GTK_FILTER_CHANGE_DIFFERENT, gtk_string_filter_keys_new (self));
+  else
+    gtk_filter_set_keys (GTK_FILTER (self), gtk_string_filter_keys_new (self));
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_EXPRESSION]);
 }
@@ -467,7 +812,13 @@ gtk_string_filter_set_ignore_case (GtkStringFilter *self,
     {
       g_free (self->search_prepared);
       self->search_prepared = gtk_string_filter_prepare (self, self->search);
-      gtk_filter_changed (GTK_FILTER (self), ignore_case ? GTK_FILTER_CHANGE_LESS_STRICT : GTK_FILTER_CHANGE_MORE_STRICT);
+      gtk_filter_changed_with_keys (GTK_FILTER (self),
+                                    ignore_case ? GTK_FILTER_CHANGE_LESS_STRICT : GTK_FILTER_CHANGE_MORE_STRICT,
+                                    gtk_string_filter_keys_new (self));
+    }
+  else
+    {
+      gtk_filter_set_keys (GTK_FILTER (self), gtk_string_filter_keys_new (self));
     }
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_IGNORE_CASE]);
@@ -512,21 +863,23 @@ gtk_string_filter_set_match_mode (GtkStringFilter *self,
 
   if (self->search_prepared && self->expression)
     {
+      GtkFilterKeys *keys = gtk_string_filter_keys_new (self);
+
       switch (old_mode)
         {
         case GTK_STRING_FILTER_MATCH_MODE_EXACT:
-          gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_LESS_STRICT);
+          gtk_filter_changed_with_keys (GTK_FILTER (self), GTK_FILTER_CHANGE_LESS_STRICT, keys);
           break;
 
         case GTK_STRING_FILTER_MATCH_MODE_SUBSTRING:
-          gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_MORE_STRICT);
+          gtk_filter_changed_with_keys (GTK_FILTER (self), GTK_FILTER_CHANGE_MORE_STRICT, keys);
           break;
 
         case GTK_STRING_FILTER_MATCH_MODE_PREFIX:
           if (mode == GTK_STRING_FILTER_MATCH_MODE_SUBSTRING)
-            gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_LESS_STRICT);
+            gtk_filter_changed_with_keys (GTK_FILTER (self), GTK_FILTER_CHANGE_LESS_STRICT, keys);
           else
-            gtk_filter_changed (GTK_FILTER (self), GTK_FILTER_CHANGE_MORE_STRICT);
+            gtk_filter_changed_with_keys (GTK_FILTER (self), GTK_FILTER_CHANGE_MORE_STRICT, keys);
           break;
 
         default:
@@ -534,6 +887,10 @@ gtk_string_filter_set_match_mode (GtkStringFilter *self,
           break;
         }
     }
+  else
+    {
+      gtk_filter_set_keys (GTK_FILTER (self), gtk_string_filter_keys_new (self));
+    }
 
   g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MATCH_MODE]);
 }
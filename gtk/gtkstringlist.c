@@ -39,6 +39,15 @@
  * GtkStringList is well-suited for any place where you would
  * typically use a `char*[]`, but need a list model.
  *
+ * To load large amounts of strings, gtk_string_list_splice_bytes()
+ * and gtk_string_list_splice_take_lines() avoid copying them.
+ *
+ * A list created with gtk_string_list_new_packed() stores its strings
+ * compactly and only creates the #GtkStringObjects wrapping them when
+ * they are requested via g_list_model_get_item(). They are only kept
+ * around while they are in use, so getting the same item twice without
+ * holding a reference may return different objects.
+ *
  * # GtkStringList as GtkBuildable
  *
  * The GtkStringList implementation of the GtkBuildable interface
@@ -60,18 +69,57 @@
 
  */
 
-#define GDK_ARRAY_ELEMENT_TYPE GtkStringObject *
-#define GDK_ARRAY_NAME objects
-#define GDK_ARRAY_TYPE_NAME Objects
-#define GDK_ARRAY_FREE_FUNC g_object_unref
-#include "gdk/gdkarrayimpl.c"
+typedef struct _GtkStringListItem GtkStringListItem;
 
 struct _GtkStringObject
 {
   GObject parent_instance;
-  char *string;
+  char *string; /* owned, unless bytes is set */
+
+  GBytes *bytes; /* keeps string alive if it points into shared storage */
 };
 
+/* By default, every item owns its object, like it always did.
+ *
+ * In packed lists, strings are stored in GBytes that are shared by all
+ * the strings added in one call, so adding many strings doesn't allocate
+ * memory for each of them. The object is created on demand and only
+ * tracked with a weak ref, so it never needs to talk back to the list,
+ * no matter which thread drops the last reference.
+ * The weak ref is allocated separately because items move around in
+ * memory and a GWeakRef must not.
+ */
+struct _GtkStringListItem
+{
+  const char *string;
+  GBytes *bytes; /* owns string in packed lists */
+  GtkStringObject *object; /* owned, NULL in packed lists */
+  GWeakRef *weak_object; /* packed lists only, allocated on demand */
+};
+
+static void
+gtk_string_list_item_clear (GtkStringListItem *item)
+{
+  if (item->object)
+    g_object_unref (item->object);
+
+  if (item->weak_object)
+    {
+      g_weak_ref_clear (item->weak_object);
+      g_free (item->weak_object);
+    }
+
+  if (item->bytes)
+    g_bytes_unref (item->bytes);
+}
+
+#define GDK_ARRAY_ELEMENT_TYPE GtkStringListItem
+#define GDK_ARRAY_NAME items
+#define GDK_ARRAY_TYPE_NAME Items
+#define GDK_ARRAY_BY_VALUE 1
+#define GDK_ARRAY_FREE_FUNC gtk_string_list_item_clear
+#include "gdk/gdkarrayimpl.c"
+
 enum {
   PROP_STRING = 1,
   PROP_NUM_PROPERTIES
@@ -89,7 +137,10 @@ gtk_string_object_finalize (GObject *object)
 {
   GtkStringObject *self = GTK_STRING_OBJECT (object);
 
-  g_free (self->string);
+  if (self->bytes)
+    g_bytes_unref (self->bytes);
+  else
+    g_free (self->string);
 
   G_OBJECT_CLASS (gtk_string_object_parent_class)->finalize (object);
 }
@@ -143,6 +194,21 @@ gtk_string_object_new_take (char *string)
   return obj;
 }
 
+/* Creates an object for a string that points into @bytes */
+static GtkStringObject *
+gtk_string_object_new_for_bytes (const char *string,
+                                 GBytes     *bytes)
+{
+  GtkStringObject *obj;
+
+  obj = g_object_new (GTK_TYPE_STRING_OBJECT, NULL);
+  obj->string = (char *) string;
+  if (bytes)
+    obj->bytes = g_bytes_ref (bytes);
+
+  return obj;
+}
+
 /**
  * gtk_string_object_new:
  * @string: (not nullable): The string to wrap
@@ -177,9 +243,19 @@ struct _GtkStringList
 {
   GObject parent_instance;
 
-  Objects items;
+  Items items;
+
+  guint packed : 1;
+};
+
+enum {
+  LIST_PROP_0,
+  LIST_PROP_PACKED,
+  LIST_NUM_PROPERTIES
 };
 
+static GParamSpec *list_properties[LIST_NUM_PROPERTIES] = { NULL, };
+
 struct _GtkStringListClass
 {
   GObjectClass parent_class;
@@ -196,7 +272,7 @@ gtk_string_list_get_n_items (GListModel *list)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
 
-  return objects_get_size (&self->items);
+  return items_get_size (&self->items);
 }
 
 static gpointer
@@ -204,11 +280,31 @@ gtk_string_list_get_item (GListModel *list,
                           guint       position)
 {
   GtkStringList *self = GTK_STRING_LIST (list);
+  GtkStringListItem *item;
+  GtkStringObject *object;
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= items_get_size (&self->items))
     return NULL;
 
-  return g_object_ref (objects_get (&self->items, position));
+  item = items_index (&self->items, position);
+  if (item->object)
+    return g_object_ref (item->object);
+
+  if (item->weak_object)
+    {
+      object = g_weak_ref_get (item->weak_object);
+      if (object)
+        return object;
+    }
+  else
+    {
+      item->weak_object = g_new0 (GWeakRef, 1);
+    }
+
+  object = gtk_string_object_new_for_bytes (item->string, item->bytes);
+  g_weak_ref_set (item->weak_object, object);
+
+  return object;
 }
 
 static void
@@ -395,23 +491,161 @@ gtk_string_list_dispose (GObject *object)
 {
   GtkStringList *self = GTK_STRING_LIST (object);
 
-  objects_clear (&self->items);
+  items_clear (&self->items);
 
   G_OBJECT_CLASS (gtk_string_list_parent_class)->dispose (object);
 }
 
+static void
+gtk_string_list_set_property (GObject      *object,
+                              guint         prop_id,
+                              const GValue *value,
+                              GParamSpec   *pspec)
+{
+  GtkStringList *self = GTK_STRING_LIST (object);
+
+  switch (prop_id)
+    {
+    case LIST_PROP_PACKED:
+      self->packed = g_value_get_boolean (value);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+gtk_string_list_get_property (GObject    *object,
+                              guint       prop_id,
+                              GValue     *value,
+                              GParamSpec *pspec)
+{
+  GtkStringList *self = GTK_STRING_LIST (object);
+
+  switch (prop_id)
+    {
+    case LIST_PROP_PACKED:
+      g_value_set_boolean (value, self->packed);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+      break;
+    }
+}
+
 static void
 gtk_string_list_class_init (GtkStringListClass *class)
 {
   GObjectClass *gobject_class = G_OBJECT_CLASS (class);
 
   gobject_class->dispose = gtk_string_list_dispose;
+  gobject_class->set_property = gtk_string_list_set_property;
+  gobject_class->get_property = gtk_string_list_get_property;
+
+  /**
+   * GtkStringList:packed:
+   *
+   * If the list stores its strings compactly and only creates
+   * objects for them while they are in use.
+   *
+   * Since: 4.2
+   */
+  list_properties[LIST_PROP_PACKED] =
+      g_param_spec_boolean ("packed",
+                            P_("Packed"),
+                            P_("If strings are stored compactly"),
+                            FALSE,
+                            GTK_PARAM_READWRITE | G_PARAM_CONSTRUCT_ONLY);
+
+  g_object_class_install_properties (gobject_class, LIST_NUM_PROPERTIES, list_properties);
 }
 
 static void
 gtk_string_list_init (GtkStringList *self)
 {
-  objects_init (&self->items);
+  items_init (&self->items);
+}
+
+/* Counts the nul-terminated strings in @data, which must
+ * end with a nul byte.
+ */
+static guint
+count_strings (const char *data,
+               gsize       size)
+{
+  const char *p, *end;
+  guint n = 0;
+
+  end = data + size;
+  for (p = data; p < end; p = (const char *) memchr (p, '\0', end - p) + 1)
+    n++;
+
+  return n;
+}
+
+/* Sets up @item for @string, which points into @bytes */
+static void
+gtk_string_list_item_init (GtkStringList     *self,
+                           GtkStringListItem *item,
+                           const char        *string,
+                           GBytes            *bytes)
+{
+  item->string = string;
+  item->weak_object = NULL;
+
+  if (self->packed)
+    {
+      item->bytes = bytes ? g_bytes_ref (bytes) : NULL;
+      item->object = NULL;
+    }
+  else
+    {
+      item->bytes = NULL;
+      item->object = gtk_string_object_new_for_bytes (string, bytes);
+    }
+}
+
+/* Sets up @item to own @object */
+static void
+gtk_string_list_item_init_object (GtkStringListItem *item,
+                                  GtkStringObject   *object)
+{
+  item->string = object->string;
+  item->bytes = NULL;
+  item->object = object;
+  item->weak_object = NULL;
+}
+
+/* Replaces @n_removals items with the @n_additions strings
+ * stored back to back in @bytes.
+ */
+static void
+gtk_string_list_splice_items (GtkStringList *self,
+                              guint          position,
+                              guint          n_removals,
+                              GBytes        *bytes,
+                              guint          n_additions)
+{
+  const char *data;
+  guint i;
+
+  items_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
+
+  if (n_additions)
+    {
+      data = g_bytes_get_data (bytes, NULL);
+      for (i = 0; i < n_additions; i++)
+        {
+          gtk_string_list_item_init (self, items_index (&self->items, position + i), data, bytes);
+          data += strlen (data) + 1;
+        }
+    }
+
+  if (n_removals || n_additions)
+    g_list_model_items_changed (G_LIST_MODEL (self), position, n_removals, n_additions);
 }
 
 /**
@@ -434,6 +668,34 @@ gtk_string_list_new (const char * const *strings)
   return self;
 }
 
+/**
+ * gtk_string_list_new_packed:
+ * @strings: (array zero-terminated=1) (nullable): The strings to put in the model
+ *
+ * Creates a new #GtkStringList with the given @strings that stores
+ * its strings compactly.
+ *
+ * The #GtkStringObjects for the strings are only created when they
+ * are requested and not kept around when nobody holds a reference
+ * to them anymore. This saves a lot of memory for large lists, but
+ * getting the same item twice may return different objects.
+ *
+ * Returns: a new #GtkStringList
+ *
+ * Since: 4.2
+ */
+GtkStringList *
+gtk_string_list_new_packed (const char * const *strings)
+{
+  GtkStringList *self;
+
+  self = g_object_new (GTK_TYPE_STRING_LIST, "packed", TRUE, NULL);
+
+  gtk_string_list_splice (self, 0, 0, strings);
+
+  return self;
+}
+
 /**
  * gtk_string_list_splice:
  * @self: a #GtkStringList
@@ -460,26 +722,165 @@ gtk_string_list_splice (GtkStringList      *self,
                         guint               n_removals,
                         const char * const *additions)
 {
+  GBytes *bytes;
   guint i, n_additions;
+  gsize size, len;
+  char *data;
 
   g_return_if_fail (GTK_IS_STRING_LIST (self));
   g_return_if_fail (position + n_removals >= position); /* overflow */
-  g_return_if_fail (position + n_removals <= objects_get_size (&self->items));
+  g_return_if_fail (position + n_removals <= items_get_size (&self->items));
 
-  if (additions)
-    n_additions = g_strv_length ((char **) additions);
-  else
-    n_additions = 0;
+  if (additions == NULL || additions[0] == NULL)
+    {
+      gtk_string_list_splice_items (self, position, n_removals, NULL, 0);
+      return;
+    }
 
-  objects_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
+  if (!self->packed)
+    {
+      n_additions = g_strv_length ((char **) additions);
+
+      items_splice (&self->items, position, n_removals, FALSE, NULL, n_additions);
+
+      for (i = 0; i < n_additions; i++)
+        {
+          gtk_string_list_item_init_object (items_index (&self->items, position + i),
+                                            gtk_string_object_new (additions[i]));
+        }
+
+      g_list_model_items_changed (G_LIST_MODEL (self), position, n_removals, n_additions);
+      return;
+    }
+
+  size = 0;
+  for (n_additions = 0; additions[n_additions]; n_additions++)
+    size += strlen (additions[n_additions]) + 1;
 
+  data = g_malloc (size);
+  size = 0;
   for (i = 0; i < n_additions; i++)
     {
-      *objects_index (&self->items, position + i) = gtk_string_object_new (additions[i]);
+      len = strlen (additions[i]) + 1;
+      memcpy (data + size, additions[i], len);
+      size += len;
     }
 
-  if (n_removals || n_additions)
-    g_list_model_items_changed (G_LIST_MODEL (self), position, n_removals, n_additions);
+  bytes = g_bytes_new_take (data, size);
+  gtk_string_list_splice_items (self, position, n_removals, bytes, n_additions);
+  g_bytes_unref (bytes);
+}
+
+/**
+ * gtk_string_list_splice_bytes:
+ * @self: a #GtkStringList
+ * @position: the position at which to make the change
+ * @n_removals: the number of strings to remove
+ * @bytes: (nullable): The strings to add, each one terminated by a
+ *     nul byte
+ *
+ * Changes @self by removing @n_removals strings and adding the
+ * strings in @bytes to it.
+ *
+ * The strings are not copied, @self keeps a reference to @bytes
+ * instead. This makes it the most efficient way to add large
+ * numbers of strings.
+ *
+ * The parameters @position and @n_removals must be correct (ie:
+ * @position + @n_removals must be less than or equal to the length
+ * of the list at the time this function is called).
+ *
+ * Since: 4.2
+ */
+void
+gtk_string_list_splice_bytes (GtkStringList *self,
+                              guint          position,
+                              guint          n_removals,
+                              GBytes        *bytes)
+{
+  const char *data;
+  gsize size;
+
+  g_return_if_fail (GTK_IS_STRING_LIST (self));
+  g_return_if_fail (position + n_removals >= position); /* overflow */
+  g_return_if_fail (position + n_removals <= items_get_size (&self->items));
+
+  if (bytes)
+    data = g_bytes_get_data (bytes, &size);
+  else
+    size = 0;
+
+  if (size == 0)
+    {
+      gtk_string_list_splice_items (self, position, n_removals, NULL, 0);
+      return;
+    }
+
+  g_return_if_fail (data[size - 1] == '\0');
+
+  gtk_string_list_splice_items (self, position, n_removals, bytes, count_strings (data, size));
+}
+
+/**
+ * gtk_string_list_splice_take_lines:
+ * @self: a #GtkStringList
+ * @position: the position at which to make the change
+ * @n_removals: the number of strings to remove
+ * @lines: (transfer full) (nullable): The lines to add
+ * @length: the length of @lines or -1 if @lines is nul-terminated
+ *
+ * Changes @self by removing @n_removals strings and adding every
+ * line of @lines as a string.
+ *
+ * @self takes ownership of @lines and splits it in place, so the
+ * lines are not copied. A newline at the end of the last line does
+ * not create an additional empty string.
+ *
+ * The parameters @position and @n_removals must be correct (ie:
+ * @position + @n_removals must be less than or equal to the length
+ * of the list at the time this function is called).
+ *
+ * Since: 4.2
+ */
+void
+gtk_string_list_splice_take_lines (GtkStringList *self,
+                                   guint          position,
+                                   guint          n_removals,
+                                   char          *lines,
+                                   gssize         length)
+{
+  GBytes *bytes;
+  char *p, *end;
+
+  g_return_if_fail (GTK_IS_STRING_LIST (self));
+  g_return_if_fail (position + n_removals >= position); /* overflow */
+  g_return_if_fail (position + n_removals <= items_get_size (&self->items));
+
+  if (lines && length < 0)
+    length = strlen (lines);
+
+  if (lines == NULL || length == 0)
+    {
+      g_free (lines);
+      gtk_string_list_splice_items (self, position, n_removals, NULL, 0);
+      return;
+    }
+
+  /* make sure the last line is terminated */
+  if (lines[length - 1] != '\n')
+    {
+      lines = g_realloc (lines, length + 1);
+      lines[length] = '\n';
+      length++;
+    }
+
+  end = lines + length;
+  for (p = memchr (lines, '\n', length); p; p = memchr (p + 1, '\n', end - p - 1))
+    *p = '\0';
+
+  bytes = g_bytes_new_take (lines, length);
+  gtk_string_list_splice_items (self, position, n_removals, bytes, count_strings (lines, length));
+  g_bytes_unref (bytes);
 }
 
 /**
@@ -498,9 +899,7 @@ gtk_string_list_append (GtkStringList *self,
 {
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new (string));
-
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  gtk_string_list_take (self, g_strdup (string));
 }
 
 /**
@@ -522,11 +921,26 @@ void
 gtk_string_list_take (GtkStringList *self,
                       char          *string)
 {
+  GtkStringListItem item;
+  GBytes *bytes;
+
   g_return_if_fail (GTK_IS_STRING_LIST (self));
 
-  objects_append (&self->items, gtk_string_object_new_take (string));
+  if (!self->packed)
+    {
+      gtk_string_list_item_init_object (&item, gtk_string_object_new_take (string));
+    }
+  else
+    {
+      bytes = string ? g_bytes_new_take (string, strlen (string) + 1) : NULL;
+      gtk_string_list_item_init (self, &item, string, bytes);
+      if (bytes)
+        g_bytes_unref (bytes);
+    }
+
+  items_append (&self->items, &item);
 
-  g_list_model_items_changed (G_LIST_MODEL (self), objects_get_size (&self->items) - 1, 0, 1);
+  g_list_model_items_changed (G_LIST_MODEL (self), items_get_size (&self->items) - 1, 0, 1);
 }
 
 /**
@@ -565,8 +979,8 @@ gtk_string_list_get_string (GtkStringList *self,
 {
   g_return_val_if_fail (GTK_IS_STRING_LIST (self), NULL);
 
-  if (position >= objects_get_size (&self->items))
+  if (position >= items_get_size (&self->items))
     return NULL;
 
-  return objects_get (&self->items, position)->string;
+  return items_get (&self->items, position)->string;
 }
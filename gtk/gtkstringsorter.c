@@ -160,11 +160,20 @@ gtk_string_sort_keys_compare (gconstpointer a,
   return gtk_ordering_from_cmpfunc (strcmp (sa, sb));
 }
 
+static const GtkSortKeysClass GTK_STRING_SORT_KEYS_CLASS;
+
 static gboolean
 gtk_string_sort_keys_is_compatible (GtkSortKeys *keys,
                                     GtkSortKeys *other)
 {
-  return FALSE;
+  GtkStringSortKeys *self = (GtkStringSortKeys *) keys;
+  GtkStringSortKeys *compare = (GtkStringSortKeys *) other;
+
+  if (other->klass != &GTK_STRING_SORT_KEYS_CLASS)
+    return FALSE;
+
+  return self->expression == compare->expression &&
+         self->ignore_case == compare->ignore_case;
 }
 
 static void
@@ -187,6 +196,29 @@ gtk_string_sort_keys_clear_key (GtkSortKeys *keys,
   g_free (*key);
 }
 
+/* The first 8 bytes of the collation key, in the order strcmp() uses */
+static guint64
+gtk_string_sort_keys_get_prefix (GtkSortKeys   *keys,
+                                 gconstpointer  key_memory)
+{
+  const guchar *s = *(const guchar **) key_memory;
+  guint64 result;
+  guint i;
+
+  if (s == NULL)
+    return G_MAXUINT64;
+
+  result = 0;
+  for (i = 0; i < 8; i++)
+    {
+      result <<= 8;
+      if (*s)
+        result |= *s++;
+    }
+
+  return result;
+}
+
 static const GtkSortKeysClass GTK_STRING_SORT_KEYS_CLASS =
 {
   gtk_string_sort_keys_free,
@@ -194,6 +226,9 @@ static const GtkSortKeysClass GTK_STRING_SORT_KEYS_CLASS =
   gtk_string_sort_keys_is_compatible,
   gtk_string_sort_keys_init_key,
   gtk_string_sort_keys_clear_key,
+  NULL,
+  NULL,
+  gtk_string_sort_keys_get_prefix,
 };
 
 static GtkSortKeys *
@@ -211,6 +246,7 @@ gtk_string_sort_keys_new (GtkStringSorter *self)
 
   result->expression = gtk_expression_ref (self->expression);
   result->ignore_case = self->ignore_case;
+  result->keys.thread_safe = TRUE;
 
   return (GtkSortKeys *) result;
 }
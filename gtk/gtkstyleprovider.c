@@ -19,6 +19,7 @@
 
 #include "gtkstyleproviderprivate.h"
 
+#include "gtkcssstaticstyleprivate.h"
 #include "gtkintl.h"
 #include "gtkprivate.h"
 
@@ -120,6 +121,9 @@ gtk_style_provider_changed (GtkStyleProvider *provider)
 {
   gtk_internal_return_if_fail (GTK_IS_STYLE_PROVIDER (provider));
 
+  /* Shared styles may have been computed with the old values */
+  gtk_css_static_style_clear_shared_cache ();
+
   g_signal_emit (provider, signals[CHANGED], 0);
 }
 
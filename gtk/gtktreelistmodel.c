@@ -416,10 +416,13 @@ gtk_tree_list_model_items_changed_cb (GListModel *model,
     }
 
   tree_added = added;
-  for (i = 0; i < added; i++)
+  if (added)
     {
-      child = gtk_rb_tree_insert_before (node->children, child);
-      child->parent = node;
+      TreeNode *tmp;
+
+      child = gtk_rb_tree_insert_many_before (node->children, child, added);
+      for (i = 0, tmp = child; i < added; i++, tmp = gtk_rb_tree_node_get_next (tmp))
+        tmp->parent = node;
     }
   if (self->autoexpand)
     {
@@ -506,13 +509,13 @@ gtk_tree_list_model_init_node (GtkTreeListModel *list,
                                     NULL);
 
   n = g_list_model_get_n_items (model);
-  node = NULL;
+  node = gtk_rb_tree_insert_many_before (self->children, NULL, n);
   for (i = 0; i < n; i++)
     {
-      node = gtk_rb_tree_insert_after (self->children, node);
       node->parent = self;
       if (list->autoexpand)
         gtk_tree_list_model_expand_node (list, node);
+      node = gtk_rb_tree_node_get_next (node);
     }
 }
 
@@ -128,6 +128,11 @@ void		  gtk_tree_view_column_cell_snapshot     (GtkTreeViewColumn  *tree_column,
 void		  _gtk_tree_view_column_cell_set_dirty	 (GtkTreeViewColumn  *tree_column,
 							  gboolean            install_handler);
 gboolean          _gtk_tree_view_column_cell_get_dirty   (GtkTreeViewColumn  *tree_column);
+int               _gtk_tree_view_column_cell_get_height  (GtkTreeViewColumn  *tree_column,
+                                                          GtkTreeModel       *tree_model,
+                                                          GtkTreeIter        *iter,
+                                                          gboolean            is_expander,
+                                                          gboolean            is_expanded);
 
 void              _gtk_tree_view_column_push_padding          (GtkTreeViewColumn  *column,
 							       int                 padding);
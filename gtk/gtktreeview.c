@@ -5638,12 +5638,9 @@ validate_row (GtkTreeView   *tree_view,
 
       original_width = _gtk_tree_view_column_get_requested_width (column);
 
-      gtk_tree_view_column_cell_set_cell_data (column, priv->model, iter,
-					       GTK_TREE_RBNODE_FLAG_SET (node, GTK_TREE_RBNODE_IS_PARENT),
-					       node->children?TRUE:FALSE);
-      gtk_tree_view_column_cell_get_size (column,
-                                          NULL, NULL,
-                                          NULL, &row_height);
+      row_height = _gtk_tree_view_column_cell_get_height (column, priv->model, iter,
+                                                          GTK_TREE_RBNODE_FLAG_SET (node, GTK_TREE_RBNODE_IS_PARENT),
+                                                          node->children?TRUE:FALSE);
 
       if (is_separator)
         {
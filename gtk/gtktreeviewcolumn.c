@@ -138,6 +138,11 @@ static void gtk_tree_view_column_buildable_init                 (GtkBuildableIfa
 typedef struct _GtkTreeViewColumnClass   GtkTreeViewColumnClass;
 typedef struct _GtkTreeViewColumnPrivate GtkTreeViewColumnPrivate;
 
+/* Models with mostly unique contents don't profit from the height
+ * cache, so we don't let it grow with the number of rows.
+ */
+#define GTK_TREE_VIEW_COLUMN_MAX_CACHED_HEIGHTS 10000
+
 struct _GtkTreeViewColumn
 {
   GInitiallyUnowned parent_instance;
@@ -192,6 +197,11 @@ struct _GtkTreeViewColumnPrivate
   gulong              remove_editable_signal;
   gulong              context_changed_signal;
 
+  /* Row heights by the values of the cell attributes, only valid for
+   * the width the context had when they were measured */
+  GHashTable         *height_cache;
+  int                 height_cache_width;
+
   /* Flags */
   guint visible             : 1;
   guint resizable           : 1;
@@ -201,6 +211,7 @@ struct _GtkTreeViewColumnPrivate
   guint maybe_reordered     : 1;
   guint reorderable         : 1;
   guint expand              : 1;
+  guint cache_heights       : 1;
 };
 
 enum
@@ -225,6 +236,7 @@ enum
   PROP_SORT_ORDER,
   PROP_SORT_COLUMN_ID,
   PROP_CELL_AREA,
+  PROP_CACHE_HEIGHTS,
   LAST_PROP
 };
 
@@ -431,6 +443,23 @@ gtk_tree_view_column_class_init (GtkTreeViewColumnClass *class)
                            GTK_TYPE_CELL_AREA,
                            GTK_PARAM_READWRITE|G_PARAM_CONSTRUCT_ONLY);
 
+  /**
+   * GtkTreeViewColumn:cache-heights:
+   *
+   * Whether rows whose cells get the same attribute values are assumed
+   * to have the same height.
+   *
+   * See gtk_tree_view_column_set_cache_heights().
+   *
+   * Since: 4.2
+   */
+  tree_column_props[PROP_CACHE_HEIGHTS] =
+      g_param_spec_boolean ("cache-heights",
+                            P_("Cache heights"),
+                            P_("Whether to reuse the heights of rows with the same contents"),
+                            FALSE,
+                            GTK_PARAM_READWRITE|G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (object_class, LAST_PROP, tree_column_props);
 }
 
@@ -557,6 +586,7 @@ gtk_tree_view_column_finalize (GObject *object)
   GtkTreeViewColumnPrivate *priv        = tree_column->priv;
 
   g_free (priv->title);
+  g_clear_pointer (&priv->height_cache, g_hash_table_unref);
 
   G_OBJECT_CLASS (gtk_tree_view_column_parent_class)->finalize (object);
 }
@@ -671,6 +701,11 @@ gtk_tree_view_column_set_property (GObject         *object,
         }
       break;
 
+    case PROP_CACHE_HEIGHTS:
+      gtk_tree_view_column_set_cache_heights (tree_column,
+                                              g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
       break;
@@ -782,6 +817,11 @@ gtk_tree_view_column_get_property (GObject         *object,
     case PROP_CELL_AREA:
       g_value_set_object (value, tree_column->priv->cell_area);
       break;
+
+    case PROP_CACHE_HEIGHTS:
+      g_value_set_boolean (value,
+                           gtk_tree_view_column_get_cache_heights (tree_column));
+      break;
       
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
@@ -2233,6 +2273,63 @@ gtk_tree_view_column_get_max_width (GtkTreeViewColumn *tree_column)
   return tree_column->priv->max_width;
 }
 
+/**
+ * gtk_tree_view_column_set_cache_heights:
+ * @tree_column: A #GtkTreeViewColumn.
+ * @cache_heights: %TRUE to reuse the heights of rows with the same contents
+ *
+ * Sets whether the height of a row in @tree_column is remembered by the
+ * values its cells get from their attributes, and reused for other rows
+ * with the same values instead of measuring them again.
+ *
+ * This speeds up showing models with many rows that often repeat the
+ * same contents. It is only correct if the cell renderers are set up
+ * with attributes alone. Rows are always measured if a cell data function
+ * is set, or if an attribute is an object or boxed type. If the
+ * renderers are changed in other ways, call
+ * gtk_tree_view_column_queue_resize().
+ *
+ * Since: 4.2
+ **/
+void
+gtk_tree_view_column_set_cache_heights (GtkTreeViewColumn *tree_column,
+                                        gboolean           cache_heights)
+{
+  GtkTreeViewColumnPrivate *priv;
+
+  g_return_if_fail (GTK_IS_TREE_VIEW_COLUMN (tree_column));
+
+  priv = tree_column->priv;
+  cache_heights = !!cache_heights;
+
+  if (priv->cache_heights == cache_heights)
+    return;
+
+  priv->cache_heights = cache_heights;
+  g_clear_pointer (&priv->height_cache, g_hash_table_unref);
+
+  g_object_notify_by_pspec (G_OBJECT (tree_column), tree_column_props[PROP_CACHE_HEIGHTS]);
+}
+
+/**
+ * gtk_tree_view_column_get_cache_heights:
+ * @tree_column: A #GtkTreeViewColumn.
+ *
+ * Returns whether row heights are reused for rows with the same
+ * contents. See gtk_tree_view_column_set_cache_heights().
+ *
+ * Returns: %TRUE if row heights are cached
+ *
+ * Since: 4.2
+ **/
+gboolean
+gtk_tree_view_column_get_cache_heights (GtkTreeViewColumn *tree_column)
+{
+  g_return_val_if_fail (GTK_IS_TREE_VIEW_COLUMN (tree_column), FALSE);
+
+  return tree_column->priv->cache_heights;
+}
+
 /**
  * gtk_tree_view_column_clicked:
  * @tree_column: a #GtkTreeViewColumn
@@ -2902,6 +2999,7 @@ _gtk_tree_view_column_cell_set_dirty (GtkTreeViewColumn *tree_column,
   priv->dirty = TRUE;
   priv->padding = 0;
   priv->width = 0;
+  g_clear_pointer (&priv->height_cache, g_hash_table_unref);
 
   /* Issue a manual reset on the context to have all
    * sizes re-requested for the context.
@@ -2926,6 +3024,73 @@ _gtk_tree_view_column_cell_get_dirty (GtkTreeViewColumn  *tree_column)
   return tree_column->priv->dirty;
 }
 
+/* Like gtk_tree_view_column_cell_set_cell_data() followed by
+ * gtk_tree_view_column_cell_get_size(), but only returns the height
+ * and looks it up in the height cache first.
+ *
+ * The cache is cleared whenever the context is reset, so the widths
+ * of cached rows have always been pushed to the current context.
+ */
+int
+_gtk_tree_view_column_cell_get_height (GtkTreeViewColumn *tree_column,
+                                       GtkTreeModel      *tree_model,
+                                       GtkTreeIter       *iter,
+                                       gboolean           is_expander,
+                                       gboolean           is_expanded)
+{
+  GtkTreeViewColumnPrivate *priv = tree_column->priv;
+  GString *key = NULL;
+  gpointer cached;
+  int width, height;
+
+  if (priv->height_cache)
+    {
+      gtk_cell_area_context_get_preferred_width (priv->cell_area_context, &width, NULL);
+      if (width != priv->height_cache_width)
+        g_clear_pointer (&priv->height_cache, g_hash_table_unref);
+    }
+
+  if (priv->cache_heights)
+    {
+      key = g_string_new (NULL);
+      g_string_append_printf (key, "%d%d\n", is_expander, is_expanded);
+
+      if (!_gtk_cell_area_append_attributes_key (priv->cell_area, tree_model, iter, key))
+        {
+          g_string_free (key, TRUE);
+          key = NULL;
+        }
+      else if (priv->height_cache &&
+               g_hash_table_lookup_extended (priv->height_cache, key->str, NULL, &cached))
+        {
+          g_string_free (key, TRUE);
+          return GPOINTER_TO_INT (cached);
+        }
+    }
+
+  gtk_tree_view_column_cell_set_cell_data (tree_column, tree_model, iter,
+                                           is_expander, is_expanded);
+  gtk_tree_view_column_cell_get_size (tree_column, NULL, NULL, &width, &height);
+
+  if (key)
+    {
+      /* Heights are measured for the width of the widest row so far */
+      if (priv->height_cache == NULL || priv->height_cache_width != width)
+        {
+          g_clear_pointer (&priv->height_cache, g_hash_table_unref);
+          priv->height_cache = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+          priv->height_cache_width = width;
+        }
+
+      if (g_hash_table_size (priv->height_cache) < GTK_TREE_VIEW_COLUMN_MAX_CACHED_HEIGHTS)
+        g_hash_table_insert (priv->height_cache, g_string_free (key, FALSE), GINT_TO_POINTER (height));
+      else
+        g_string_free (key, TRUE);
+    }
+
+  return height;
+}
+
 /**
  * gtk_tree_view_column_cell_get_position:
  * @tree_column: a #GtkTreeViewColumn
@@ -153,6 +153,11 @@ void                    gtk_tree_view_column_set_max_width       (GtkTreeViewCol
 								  int                      max_width);
 GDK_AVAILABLE_IN_ALL
 int                     gtk_tree_view_column_get_max_width       (GtkTreeViewColumn       *tree_column);
+GDK_AVAILABLE_IN_4_2
+void                    gtk_tree_view_column_set_cache_heights   (GtkTreeViewColumn       *tree_column,
+								  gboolean                 cache_heights);
+GDK_AVAILABLE_IN_4_2
+gboolean                gtk_tree_view_column_get_cache_heights   (GtkTreeViewColumn       *tree_column);
 GDK_AVAILABLE_IN_ALL
 void                    gtk_tree_view_column_clicked             (GtkTreeViewColumn       *tree_column);
 
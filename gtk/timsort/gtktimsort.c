@@ -373,3 +373,203 @@ gtk_tim_sort_step (GtkTimSort    *self,
   return result;
 }
 
+
+/*
+ * The minimum number of elements that a single thread gets to sort
+ * in gtk_tim_sort_parallel(). Below this, the overhead of handing
+ * out the work outweighs the time spent sorting.
+ */
+#define PARALLEL_MIN_CHUNK (8 * 1024)
+
+/*
+ * The maximum merge size used by the threads in gtk_tim_sort_parallel().
+ * This limits how long it takes for a thread to notice cancellation.
+ */
+#define PARALLEL_MAX_MERGE_SIZE (64 * 1024)
+
+typedef struct _GtkTimSortParallel GtkTimSortParallel;
+typedef struct _GtkTimSortParallelJob GtkTimSortParallelJob;
+
+struct _GtkTimSortParallel
+{
+  gsize element_size;
+  GCompareDataFunc compare_func;
+  gpointer data;
+  GCancellable *cancellable;
+
+  GMutex lock;
+  GCond cond;
+  gsize n_pending;
+};
+
+struct _GtkTimSortParallelJob
+{
+  GtkTimSortParallel *parallel;
+  gpointer base;
+  gsize size;
+  gsize runs[3]; /* 0-terminated list of presorted runs */
+};
+
+static void
+gtk_tim_sort_parallel_run_job (gpointer data,
+                               gpointer user_data)
+{
+  GtkTimSortParallelJob *job = data;
+  GtkTimSortParallel *parallel = job->parallel;
+  GtkTimSort sort;
+
+  gtk_tim_sort_init (&sort,
+                     job->base,
+                     job->size,
+                     parallel->element_size,
+                     parallel->compare_func,
+                     parallel->data);
+  gtk_tim_sort_set_runs (&sort, job->runs);
+  gtk_tim_sort_set_max_merge_size (&sort, PARALLEL_MAX_MERGE_SIZE);
+
+  while (!g_cancellable_is_cancelled (parallel->cancellable) &&
+         gtk_tim_sort_step (&sort, NULL));
+
+  gtk_tim_sort_finish (&sort);
+
+  g_mutex_lock (&parallel->lock);
+  parallel->n_pending--;
+  if (parallel->n_pending == 0)
+    g_cond_signal (&parallel->cond);
+  g_mutex_unlock (&parallel->lock);
+}
+
+/* The threads are shared by all parallel sorts, so that sorting
+ * doesn't need to spawn new ones every time.
+ */
+static GThreadPool *
+gtk_tim_sort_parallel_get_pool (void)
+{
+  static GThreadPool *pool = NULL;
+
+  if (g_once_init_enter (&pool))
+    {
+      GThreadPool *new_pool;
+
+      new_pool = g_thread_pool_new (gtk_tim_sort_parallel_run_job,
+                                    NULL,
+                                    g_get_num_processors (),
+                                    FALSE,
+                                    NULL);
+      g_once_init_leave (&pool, new_pool);
+    }
+
+  return pool;
+}
+
+static void
+gtk_tim_sort_parallel_run_jobs (GtkTimSortParallel    *parallel,
+                                GtkTimSortParallelJob *jobs,
+                                gsize                  n_jobs)
+{
+  GThreadPool *pool = gtk_tim_sort_parallel_get_pool ();
+  gsize i;
+
+  parallel->n_pending = n_jobs;
+
+  for (i = 0; i < n_jobs; i++)
+    g_thread_pool_push (pool, &jobs[i], NULL);
+
+  g_mutex_lock (&parallel->lock);
+  while (parallel->n_pending > 0)
+    g_cond_wait (&parallel->cond, &parallel->lock);
+  g_mutex_unlock (&parallel->lock);
+}
+
+/*<private>
+ * gtk_tim_sort_parallel:
+ * @base: the array to sort
+ * @size: number of elements in @base
+ * @element_size: size of a single element
+ * @compare_func: the function to compare elements with
+ * @user_data: data to pass to @compare_func
+ * @n_threads: the maximum number of threads to use
+ * @cancellable: (nullable): a #GCancellable to abort the sort
+ *
+ * Sorts @base like gtk_tim_sort(), but splits the array into
+ * chunks that are sorted on up to @n_threads threads at the same
+ * time. The sorted chunks are then merged pairwise, again in
+ * parallel, until a single sorted run remains.
+ *
+ * @compare_func must be safe to call from multiple threads at
+ * the same time.
+ *
+ * This function blocks until the sort is done. If @cancellable
+ * gets cancelled from another thread, the sort is aborted early
+ * and the contents of @base are left in an unspecified order.
+ *
+ * Returns: %TRUE if the array was sorted, %FALSE if the sort
+ *     was cancelled
+ **/
+gboolean
+gtk_tim_sort_parallel (gpointer          base,
+                       gsize             size,
+                       gsize             element_size,
+                       GCompareDataFunc  compare_func,
+                       gpointer          user_data,
+                       guint             n_threads,
+                       GCancellable     *cancellable)
+{
+  GtkTimSortParallel parallel = { element_size, compare_func, user_data, cancellable, };
+  GtkTimSortParallelJob *jobs;
+  gsize i, n_jobs, n_merged;
+
+  n_jobs = MIN (n_threads, size / PARALLEL_MIN_CHUNK);
+  if (n_jobs <= 1)
+    {
+      GtkTimSortParallelJob job = { &parallel, base, size, { 0, } };
+
+      parallel.n_pending = 1;
+      gtk_tim_sort_parallel_run_job (&job, NULL);
+
+      return !g_cancellable_is_cancelled (cancellable);
+    }
+
+  g_mutex_init (&parallel.lock);
+  g_cond_init (&parallel.cond);
+
+  jobs = g_new (GtkTimSortParallelJob, n_jobs);
+  for (i = 0; i < n_jobs; i++)
+    {
+      gsize start = i * size / n_jobs;
+      gsize end = (i + 1) * size / n_jobs;
+
+      jobs[i].parallel = &parallel;
+      jobs[i].base = (char *) base + start * element_size;
+      jobs[i].size = end - start;
+      jobs[i].runs[0] = 0;
+    }
+
+  gtk_tim_sort_parallel_run_jobs (&parallel, jobs, n_jobs);
+
+  while (n_jobs > 1 && !g_cancellable_is_cancelled (cancellable))
+    {
+      for (i = 0, n_merged = 0; i + 1 < n_jobs; i += 2, n_merged++)
+        {
+          jobs[n_merged].base = jobs[i].base;
+          jobs[n_merged].runs[0] = jobs[i].size;
+          jobs[n_merged].runs[1] = jobs[i + 1].size;
+          jobs[n_merged].runs[2] = 0;
+          jobs[n_merged].size = jobs[i].size + jobs[i + 1].size;
+        }
+
+      gtk_tim_sort_parallel_run_jobs (&parallel, jobs, n_merged);
+
+      /* an odd run out waits for the next round */
+      if (i < n_jobs)
+        jobs[n_merged++] = jobs[i];
+
+      n_jobs = n_merged;
+    }
+
+  g_free (jobs);
+  g_cond_clear (&parallel.cond);
+  g_mutex_clear (&parallel.lock);
+
+  return !g_cancellable_is_cancelled (cancellable);
+}
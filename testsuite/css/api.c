@@ -33,6 +33,65 @@ gtk_css_provider_load_data_not_null_terminated (void)
   g_object_unref (p);
 }
 
+static void
+test_class_change_ancestor (void)
+{
+  GtkCssProvider *provider;
+  GtkWidget *box, *label, *inner, *deep;
+  GdkRGBA color, red, blue;
+
+  provider = gtk_css_provider_new ();
+  gtk_css_provider_load_from_data (provider,
+                                   "label.api-test { color: rgb(0,0,255); }\n"
+                                   ".api-test-outer label.api-test { color: rgb(255,0,0); }",
+                                   -1);
+  gtk_style_context_add_provider_for_display (gdk_display_get_default (),
+                                              GTK_STYLE_PROVIDER (provider),
+                                              GTK_STYLE_PROVIDER_PRIORITY_APPLICATION);
+
+  gdk_rgba_parse (&red, "rgb(255,0,0)");
+  gdk_rgba_parse (&blue, "rgb(0,0,255)");
+
+  box = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  g_object_ref_sink (box);
+  label = gtk_label_new ("");
+  gtk_widget_add_css_class (label, "api-test");
+  gtk_box_append (GTK_BOX (box), label);
+  /* the selector doesn't match inner, but must still reach deep */
+  inner = gtk_box_new (GTK_ORIENTATION_HORIZONTAL, 0);
+  gtk_box_append (GTK_BOX (box), inner);
+  deep = gtk_label_new ("");
+  gtk_widget_add_css_class (deep, "api-test");
+  gtk_box_append (GTK_BOX (inner), deep);
+
+  gtk_style_context_get_color (gtk_widget_get_style_context (label), &color);
+  g_assert_true (gdk_rgba_equal (&color, &blue));
+  gtk_style_context_get_color (gtk_widget_get_style_context (deep), &color);
+  g_assert_true (gdk_rgba_equal (&color, &blue));
+
+  /* only used to match ancestors */
+  gtk_widget_add_css_class (box, "api-test-outer");
+  gtk_style_context_get_color (gtk_widget_get_style_context (label), &color);
+  g_assert_true (gdk_rgba_equal (&color, &red));
+  gtk_style_context_get_color (gtk_widget_get_style_context (deep), &color);
+  g_assert_true (gdk_rgba_equal (&color, &red));
+
+  /* not used by any selector */
+  gtk_widget_add_css_class (box, "api-test-unused");
+  gtk_style_context_get_color (gtk_widget_get_style_context (label), &color);
+  g_assert_true (gdk_rgba_equal (&color, &red));
+
+  gtk_widget_remove_css_class (box, "api-test-outer");
+  gtk_style_context_get_color (gtk_widget_get_style_context (label), &color);
+  g_assert_true (gdk_rgba_equal (&color, &blue));
+  gtk_style_context_get_color (gtk_widget_get_style_context (deep), &color);
+  g_assert_true (gdk_rgba_equal (&color, &blue));
+
+  g_object_unref (box);
+  gtk_style_context_remove_provider_for_display (gdk_display_get_default (),
+                                                 GTK_STYLE_PROVIDER (provider));
+  g_object_unref (provider);
+}
 
 int
 main (int argc, char *argv[])
@@ -41,6 +100,7 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/gtk_css_provider_load_data/not_null_terminated",
       gtk_css_provider_load_data_not_null_terminated);
+  g_test_add_func ("/gtk_css_node/class_change/ancestor", test_class_change_ancestor);
 
   return g_test_run ();
 }
@@ -0,0 +1,201 @@
+#include <gtk/gtk.h>
+
+static char *
+get_string_counted (GtkStringObject *object,
+                    guint           *counter)
+{
+  (*counter)++;
+
+  return g_strdup (gtk_string_object_get_string (object));
+}
+
+static GtkStringList *
+new_string_list (guint n_items)
+{
+  GtkStringList *list;
+  guint i;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < n_items; i++)
+    {
+      char *s = g_strdup_printf ("%03u", (i * 37) % n_items);
+      gtk_string_list_append (list, s);
+      g_free (s);
+    }
+
+  return list;
+}
+
+static const char *
+get_string (GListModel *model,
+            guint       position)
+{
+  GtkStringObject *object;
+  const char *result;
+
+  object = g_list_model_get_item (model, position);
+  result = gtk_string_object_get_string (object);
+  g_object_unref (object);
+
+  return result;
+}
+
+/* Sorting the other way keeps the keys of the sort column */
+static void
+test_sort_invert (void)
+{
+  GtkColumnViewColumn *column;
+  GtkSortListModel *model;
+  GtkExpression *expression;
+  GtkSorter *sorter;
+  GtkWidget *view;
+  guint n_keys = 0;
+
+  view = g_object_ref_sink (gtk_column_view_new (NULL));
+
+  expression = gtk_cclosure_expression_new (G_TYPE_STRING, NULL,
+                                            0, NULL,
+                                            G_CALLBACK (get_string_counted),
+                                            &n_keys, NULL);
+  sorter = GTK_SORTER (gtk_string_sorter_new (expression));
+  column = gtk_column_view_column_new ("Strings", NULL);
+  gtk_column_view_column_set_sorter (column, sorter);
+  g_object_unref (sorter);
+  gtk_column_view_append_column (GTK_COLUMN_VIEW (view), column);
+
+  model = gtk_sort_list_model_new (G_LIST_MODEL (new_string_list (100)),
+                                   g_object_ref (gtk_column_view_get_sorter (GTK_COLUMN_VIEW (view))));
+  g_assert_cmpuint (n_keys, ==, 0);
+
+  gtk_column_view_sort_by_column (GTK_COLUMN_VIEW (view), column, GTK_SORT_ASCENDING);
+  g_assert_cmpuint (n_keys, ==, 100);
+  g_assert_cmpstr (get_string (G_LIST_MODEL (model), 0), ==, "000");
+
+  gtk_column_view_sort_by_column (GTK_COLUMN_VIEW (view), column, GTK_SORT_DESCENDING);
+  g_assert_cmpuint (n_keys, ==, 100);
+  g_assert_cmpstr (get_string (G_LIST_MODEL (model), 0), ==, "099");
+
+  gtk_column_view_sort_by_column (GTK_COLUMN_VIEW (view), column, GTK_SORT_ASCENDING);
+  g_assert_cmpuint (n_keys, ==, 100);
+  g_assert_cmpstr (get_string (G_LIST_MODEL (model), 0), ==, "000");
+
+  g_object_unref (model);
+  g_object_unref (column);
+  g_object_unref (view);
+}
+
+static void
+setup_cb (GtkSignalListItemFactory *factory,
+          GtkListItem              *list_item,
+          guint                    *counters)
+{
+  counters[0]++;
+  gtk_list_item_set_child (list_item, gtk_label_new (NULL));
+}
+
+static void
+teardown_cb (GtkSignalListItemFactory *factory,
+             GtkListItem              *list_item,
+             guint                    *counters)
+{
+  counters[1]++;
+}
+
+static GtkColumnViewColumn *
+new_counted_column (guint *counters)
+{
+  GtkListItemFactory *factory;
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_cb), counters);
+  g_signal_connect (factory, "teardown", G_CALLBACK (teardown_cb), counters);
+
+  return gtk_column_view_column_new (NULL, factory);
+}
+
+#define assert_counters(counters, setups, teardowns) G_STMT_START{ \
+  g_assert_cmpuint ((counters)[0], ==, (setups)); \
+  g_assert_cmpuint ((counters)[1], ==, (teardowns)); \
+}G_STMT_END
+
+/* Released rows keep their cells set up, but never come back
+ * with the cells of an outdated set of columns.
+ */
+static void
+test_pool_reuse (void)
+{
+  const char *strings[] = { "a", "b", "c", "d", "e", NULL };
+  GtkColumnViewColumn *first, *second;
+  GtkStringList *list;
+  GtkWidget *window, *view;
+  guint first_counters[2] = { 0, 0 };
+  guint second_counters[2] = { 0, 0 };
+
+  list = gtk_string_list_new (strings);
+  view = gtk_column_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (g_object_ref (list)))));
+  first = new_counted_column (first_counters);
+  gtk_column_view_append_column (GTK_COLUMN_VIEW (view), first);
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), view);
+  assert_counters (first_counters, 5, 0);
+
+  /* Rows leaving the view and new rows coming in, like when scrolling,
+   * reuse the cells.
+   */
+  gtk_string_list_splice (list, 0, 5, NULL);
+  assert_counters (first_counters, 5, 0);
+  gtk_string_list_splice (list, 0, 0, strings);
+  assert_counters (first_counters, 5, 0);
+
+  /* A column added while rows are pooled drops the pool, so that
+   * every new row gets a cell for it.
+   */
+  gtk_string_list_splice (list, 0, 5, NULL);
+  second = new_counted_column (second_counters);
+  gtk_column_view_append_column (GTK_COLUMN_VIEW (view), second);
+  assert_counters (first_counters, 5, 5);
+  gtk_string_list_splice (list, 0, 0, strings);
+  assert_counters (first_counters, 10, 5);
+  assert_counters (second_counters, 5, 0);
+
+  /* A column added to visible rows sets up cells in the visible rows
+   * only, and those rows are reused with both cells.
+   */
+  gtk_column_view_remove_column (GTK_COLUMN_VIEW (view), second);
+  assert_counters (second_counters, 5, 5);
+  gtk_column_view_append_column (GTK_COLUMN_VIEW (view), second);
+  assert_counters (second_counters, 10, 5);
+  gtk_string_list_splice (list, 0, 5, NULL);
+  gtk_string_list_splice (list, 0, 0, strings);
+  assert_counters (first_counters, 10, 5);
+  assert_counters (second_counters, 10, 5);
+
+  /* Removing a column while rows are pooled tears down the pooled rows
+   * with all their cells.
+   */
+  gtk_string_list_splice (list, 0, 5, NULL);
+  gtk_column_view_remove_column (GTK_COLUMN_VIEW (view), second);
+  assert_counters (first_counters, 10, 10);
+  assert_counters (second_counters, 10, 10);
+  gtk_string_list_splice (list, 0, 0, strings);
+  assert_counters (first_counters, 15, 10);
+  assert_counters (second_counters, 10, 10);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  assert_counters (first_counters, 15, 15);
+
+  g_object_unref (first);
+  g_object_unref (second);
+  g_object_unref (list);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/columnview/sort-invert", test_sort_invert);
+  g_test_add_func ("/columnview/pool-reuse", test_pool_reuse);
+
+  return g_test_run ();
+}
@@ -16,6 +16,7 @@
  */
 
 #include <locale.h>
+#include <string.h>
 
 #include <gtk/gtk.h>
 
@@ -450,6 +451,193 @@ test_model_changes (gconstpointer model_id)
   g_object_unref (multi);
 }
 
+static char *
+create_random_string (guint max_length)
+{
+  /* mix ASCII of both cases with strings that need normalizing */
+  static const char *pieces[] = { "a", "B", "c", "A", "b", "C", "é", "E\xcc\x81", "ß", "SS" };
+  GString *string;
+  guint i, length;
+
+  length = g_test_rand_int_range (0, max_length + 1);
+  string = g_string_new (NULL);
+  for (i = 0; i < length; i++)
+    g_string_append (string, pieces[g_test_rand_int_range (0, G_N_ELEMENTS (pieces))]);
+
+  return g_string_free (string, FALSE);
+}
+
+static char *
+prepare_string (const char *s,
+                gboolean    ignore_case)
+{
+  char *tmp, *result;
+
+  if (s[0] == '\0')
+    return NULL;
+
+  tmp = g_utf8_normalize (s, -1, G_NORMALIZE_ALL);
+  if (!ignore_case)
+    return tmp;
+
+  result = g_utf8_casefold (tmp, -1);
+  g_free (tmp);
+  return result;
+}
+
+/* What GtkStringFilter did before it got its own matcher */
+static gboolean
+reference_match (const char               *string,
+                 const char               *search,
+                 gboolean                  ignore_case,
+                 GtkStringFilterMatchMode  match_mode)
+{
+  char *prepared, *search_prepared;
+  gboolean result;
+
+  search_prepared = prepare_string (search, ignore_case);
+  if (search_prepared == NULL)
+    return TRUE;
+
+  prepared = prepare_string (string, ignore_case);
+  if (prepared == NULL)
+    result = FALSE;
+  else if (match_mode == GTK_STRING_FILTER_MATCH_MODE_EXACT)
+    result = strcmp (prepared, search_prepared) == 0;
+  else if (match_mode == GTK_STRING_FILTER_MATCH_MODE_SUBSTRING)
+    result = strstr (prepared, search_prepared) != NULL;
+  else
+    result = g_str_has_prefix (prepared, search_prepared);
+
+  g_free (prepared);
+  g_free (search_prepared);
+
+  return result;
+}
+
+/* Compare GtkStringFilter - both with and without a filter
+ * model caching prepared strings - with the straightforward
+ * implementation.
+ */
+static void
+test_string_filter (void)
+{
+  GtkStringFilterMatchMode match_mode;
+  GtkFilterListModel *model;
+  GtkStringFilter *filter;
+  GListModel *source;
+  gboolean ignore_case;
+  char *search;
+  guint i, j, n;
+
+  source = G_LIST_MODEL (gtk_string_list_new (NULL));
+  for (i = 0; i < 1000; i++)
+    {
+      char *s = create_random_string (8);
+      gtk_string_list_append (GTK_STRING_LIST (source), s);
+      g_free (s);
+    }
+
+  filter = gtk_string_filter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string"));
+  model = gtk_filter_list_model_new (g_object_ref (source), g_object_ref (GTK_FILTER (filter)));
+
+  for (i = 0; i < 100; i++)
+    {
+      search = create_random_string (3);
+      match_mode = g_test_rand_int_range (GTK_STRING_FILTER_MATCH_MODE_EXACT, GTK_STRING_FILTER_MATCH_MODE_PREFIX + 1);
+      ignore_case = g_test_rand_bit ();
+      gtk_string_filter_set_search (filter, search);
+      gtk_string_filter_set_match_mode (filter, match_mode);
+      gtk_string_filter_set_ignore_case (filter, ignore_case);
+
+      n = 0;
+      for (j = 0; j < g_list_model_get_n_items (source); j++)
+        {
+          GtkStringObject *item = g_list_model_get_item (source, j);
+          const char *string = gtk_string_object_get_string (item);
+          gboolean expected = reference_match (string, search, ignore_case, match_mode);
+
+          if (expected != gtk_filter_match (GTK_FILTER (filter), item))
+            g_error ("filter mismatch for \"%s\" in \"%s\"", search, string);
+
+          if (expected)
+            {
+              GtkStringObject *filtered = g_list_model_get_item (G_LIST_MODEL (model), n);
+              g_assert_true (filtered == item);
+              g_object_unref (filtered);
+              n++;
+            }
+
+          g_object_unref (item);
+        }
+      g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, n);
+
+      g_free (search);
+    }
+
+  g_object_unref (model);
+  g_object_unref (filter);
+  g_object_unref (source);
+}
+
+static gboolean
+reference_filter_func (gpointer item,
+                       gpointer search)
+{
+  return reference_match (gtk_string_object_get_string (item), search, TRUE, GTK_STRING_FILTER_MATCH_MODE_SUBSTRING);
+}
+
+/* Substring filtering of a large model with GtkStringFilter and with
+ * a custom filter that prepares every string, like GtkStringFilter
+ * used to do.
+ */
+static void
+test_string_filter_performance (void)
+{
+  guint n = g_test_perf () ? 1000000 : 1000;
+  GtkFilterListModel *model;
+  GtkFilter *filter, *reference;
+  GListModel *source;
+  double elapsed, elapsed_reference;
+  guint i, n_matches;
+
+  source = G_LIST_MODEL (gtk_string_list_new (NULL));
+  for (i = 0; i < n; i++)
+    {
+      char *s = g_strdup_printf ("Item number %u of %u in a Large Model", (guint) g_test_rand_int_range (0, 1000), i);
+      gtk_string_list_append (GTK_STRING_LIST (source), s);
+      g_free (s);
+    }
+
+  filter = GTK_FILTER (gtk_string_filter_new (gtk_property_expression_new (GTK_TYPE_STRING_OBJECT, NULL, "string")));
+  gtk_string_filter_set_search (GTK_STRING_FILTER (filter), "42 OF");
+  reference = GTK_FILTER (gtk_custom_filter_new (reference_filter_func, (gpointer) "42 OF", NULL));
+  model = gtk_filter_list_model_new (g_object_ref (source), NULL);
+
+  g_test_timer_start ();
+  gtk_filter_list_model_set_filter (model, reference);
+  elapsed_reference = g_test_timer_elapsed ();
+  n_matches = g_list_model_get_n_items (G_LIST_MODEL (model));
+
+  gtk_filter_list_model_set_filter (model, NULL);
+
+  g_test_timer_start ();
+  gtk_filter_list_model_set_filter (model, filter);
+  elapsed = g_test_timer_elapsed ();
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, n_matches);
+
+  if (g_test_perf ())
+    {
+      g_test_minimized_result (elapsed_reference, "substring filtering %u items, preparing every string: %gsec", n, elapsed_reference);
+      g_test_minimized_result (elapsed, "substring filtering %u items with GtkStringFilter: %gsec", n, elapsed);
+    }
+
+  g_object_unref (model);
+  g_object_unref (reference);
+  g_object_unref (filter);
+  g_object_unref (source);
+}
+
 static void
 add_test_for_all_models (const char    *name,
                          GTestDataFunc  test_func)
@@ -473,6 +661,8 @@ main (int argc, char *argv[])
   add_test_for_all_models ("no-filter", test_no_filter);
   add_test_for_all_models ("two-filters", test_two_filters);
   add_test_for_all_models ("model-changes", test_model_changes);
+  g_test_add_func ("/filterlistmodel/string-filter", test_string_filter);
+  g_test_add_func ("/filterlistmodel/string-filter-performance", test_string_filter_performance);
 
   return g_test_run ();
 }
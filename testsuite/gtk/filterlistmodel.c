@@ -18,6 +18,7 @@
  */
 
 #include <locale.h>
+#include <string.h>
 
 #include <gtk/gtk.h>
 
@@ -376,6 +377,118 @@ test_incremental (void)
   g_object_unref (filter);
 }
 
+static char *
+get_string (gpointer  object,
+            guint    *n_calls)
+{
+  (*n_calls)++;
+
+  return g_strdup_printf ("%u", GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark)));
+}
+
+/* Test that changing the search of a string filter doesn't
+ * evaluate the expression for items again.
+ */
+static void
+test_string_keys (void)
+{
+  GtkFilterListModel *filter;
+  GtkFilter *string;
+  guint n_calls = 0;
+  GListStore *store;
+
+  string = GTK_FILTER (gtk_string_filter_new (
+               gtk_cclosure_expression_new (G_TYPE_STRING,
+                                            NULL,
+                                            0, NULL,
+                                            G_CALLBACK (get_string),
+                                            &n_calls, NULL)));
+  filter = new_model (100, NULL, NULL);
+  gtk_filter_list_model_set_filter (filter, string);
+  assert_model (filter, "1 2 3 4 5 6 7 8 9 10 11 12 13 14 15 16 17 18 19 20 21 22 23 24 25 26 27 28 29 30 31 32 33 34 35 36 37 38 39 40 41 42 43 44 45 46 47 48 49 50 51 52 53 54 55 56 57 58 59 60 61 62 63 64 65 66 67 68 69 70 71 72 73 74 75 76 77 78 79 80 81 82 83 84 85 86 87 88 89 90 91 92 93 94 95 96 97 98 99 100");
+  assert_changes (filter, "");
+  g_assert_cmpuint (n_calls, ==, 0);
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (string), "1");
+  assert_model (filter, "1 10 11 12 13 14 15 16 17 18 19 21 31 41 51 61 71 81 91 100");
+  ignore_changes (filter);
+  g_assert_cmpuint (n_calls, ==, 100);
+
+  gtk_string_filter_set_search (GTK_STRING_FILTER (string), "10");
+  assert_model (filter, "10 100");
+  ignore_changes (filter);
+  gtk_string_filter_set_search (GTK_STRING_FILTER (string), "2");
+  assert_model (filter, "2 12 20 21 22 23 24 25 26 27 28 29 32 42 52 62 72 82 92");
+  ignore_changes (filter);
+  g_assert_cmpuint (n_calls, ==, 100);
+
+  /* new items need their keys created */
+  store = G_LIST_STORE (gtk_filter_list_model_get_model (filter));
+  add (store, 200);
+  assert_model (filter, "2 12 20 21 22 23 24 25 26 27 28 29 32 42 52 62 72 82 92 200");
+  assert_changes (filter, "+19");
+  g_assert_cmpuint (n_calls, ==, 101);
+
+  /* changing how strings are prepared requires new keys */
+  gtk_string_filter_set_ignore_case (GTK_STRING_FILTER (string), FALSE);
+  assert_model (filter, "2 12 20 21 22 23 24 25 26 27 28 29 32 42 52 62 72 82 92 200");
+  g_assert_cmpuint (n_calls, >, 101);
+
+  g_object_unref (filter);
+  g_object_unref (string);
+}
+
+/* Test that filtering a model large enough to be split across
+ * threads gives the same result as filtering it item by item.
+ */
+static void
+test_parallel (void)
+{
+  GtkFilterListModel *filter;
+  GtkFilter *string;
+  guint n_calls = 0;
+  guint i, n_expected;
+  char *s;
+
+  string = GTK_FILTER (gtk_string_filter_new (
+               gtk_cclosure_expression_new (G_TYPE_STRING,
+                                            NULL,
+                                            0, NULL,
+                                            G_CALLBACK (get_string),
+                                            &n_calls, NULL)));
+  gtk_string_filter_set_search (GTK_STRING_FILTER (string), "7");
+  filter = new_model (200000, NULL, NULL);
+  gtk_filter_list_model_set_filter (filter, string);
+  g_assert_cmpuint (gtk_filter_list_model_get_pending (filter), ==, 0);
+  g_assert_cmpuint (n_calls, ==, 200000);
+
+  n_expected = 0;
+  for (i = 1; i <= 200000; i++)
+    {
+      s = g_strdup_printf ("%u", i);
+      if (strchr (s, '7'))
+        {
+          g_assert_cmpuint (get (G_LIST_MODEL (filter), n_expected), ==, i);
+          n_expected++;
+        }
+      g_free (s);
+    }
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (filter)), ==, n_expected);
+
+  /* refiltering reuses the keys */
+  gtk_string_filter_set_search (GTK_STRING_FILTER (string), "77");
+  g_assert_cmpuint (n_calls, ==, 200000);
+  for (i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (filter)); i++)
+    {
+      s = g_strdup_printf ("%u", get (G_LIST_MODEL (filter), i));
+      g_assert_nonnull (strstr (s, "77"));
+      g_free (s);
+    }
+
+  g_object_unref (filter);
+  g_object_unref (string);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -389,6 +502,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/filterlistmodel/empty_set_filter", test_empty_set_filter);
   g_test_add_func ("/filterlistmodel/change_filter", test_change_filter);
   g_test_add_func ("/filterlistmodel/incremental", test_incremental);
+  g_test_add_func ("/filterlistmodel/string_keys", test_string_keys);
+  g_test_add_func ("/filterlistmodel/parallel", test_parallel);
 
   return g_test_run ();
 }
@@ -394,6 +394,52 @@ test_submodel_remove (void)
   g_object_unref (flat);
 }
 
+/* Test that positions stay right when lots of submodels
+ * change in a row without the model being queried in between.
+ */
+static void
+test_submodel_many (void)
+{
+  GtkFlattenListModel *flat;
+  GListStore *model, *store[100];
+  GString *changes, *expected;
+  guint i;
+
+  model = g_list_store_new (G_TYPE_LIST_MODEL);
+  for (i = 0; i < G_N_ELEMENTS (store); i++)
+    store[i] = add_store (model, 2 * i + 1, 2 * i + 1, 1);
+  flat = new_model (model);
+  changes = g_object_get_qdata (G_OBJECT (flat), changes_quark);
+  expected = g_string_new (NULL);
+
+  for (i = 0; i < G_N_ELEMENTS (store); i++)
+    {
+      add (store[i], 2 * i + 2);
+      g_string_append_printf (expected, "%s+%u", i > 0 ? ", " : "", 2 * i + 1);
+    }
+  g_assert_cmpstr (changes->str, ==, expected->str);
+  g_string_set_size (changes, 0);
+  g_string_set_size (expected, 0);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (flat)), ==, 2 * G_N_ELEMENTS (store));
+  for (i = 0; i < 2 * G_N_ELEMENTS (store); i++)
+    g_assert_cmpuint (get (G_LIST_MODEL (flat), i), ==, i + 1);
+
+  for (i = G_N_ELEMENTS (store); i > 0; i--)
+    {
+      g_list_store_remove (store[i - 1], 0);
+      g_string_append_printf (expected, "%s-%u", expected->len ? ", " : "", 2 * (i - 1));
+    }
+  g_assert_cmpstr (changes->str, ==, expected->str);
+  g_string_set_size (changes, 0);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (flat)), ==, G_N_ELEMENTS (store));
+  for (i = 0; i < G_N_ELEMENTS (store); i++)
+    g_assert_cmpuint (get (G_LIST_MODEL (flat), i), ==, 2 * i + 2);
+
+  g_string_free (expected, TRUE);
+  g_object_unref (model);
+  g_object_unref (flat);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -411,6 +457,7 @@ main (int argc, char *argv[])
   g_test_add_func ("/flattenlistmodel/submodel/add2", test_submodel_add2);
   g_test_add_func ("/flattenlistmodel/model/remove", test_model_remove);
   g_test_add_func ("/flattenlistmodel/submodel/remove", test_submodel_remove);
+  g_test_add_func ("/flattenlistmodel/submodel/many", test_submodel_many);
 #endif
 
   return g_test_run ();
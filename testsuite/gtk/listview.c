@@ -0,0 +1,417 @@
+#include <string.h>
+
+#include <gtk/gtk.h>
+
+static void
+setup_cb (GtkSignalListItemFactory *factory,
+          GtkListItem              *list_item,
+          guint                    *counters)
+{
+  counters[0]++;
+  gtk_list_item_set_child (list_item, gtk_label_new (NULL));
+}
+
+static void
+teardown_cb (GtkSignalListItemFactory *factory,
+             GtkListItem              *list_item,
+             guint                    *counters)
+{
+  counters[1]++;
+}
+
+static guint
+count_rows (GtkWidget *view)
+{
+  GtkWidget *child;
+  guint n = 0;
+
+  for (child = gtk_widget_get_first_child (view);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      if (g_str_equal (gtk_widget_get_css_name (child), "row"))
+        n++;
+    }
+
+  return n;
+}
+
+static void
+test_pool_reuse (void)
+{
+  const char *strings[] = { "a", "b", "c", "d", "e", NULL };
+  GtkListItemFactory *factory;
+  GtkStringList *list;
+  GtkWidget *window, *view;
+  guint counters[2] = { 0, 0 };
+
+  list = gtk_string_list_new (strings);
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_cb), counters);
+  g_signal_connect (factory, "teardown", G_CALLBACK (teardown_cb), counters);
+  view = gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (g_object_ref (list)))),
+                            factory);
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), view);
+
+  g_assert_cmpuint (count_rows (view), ==, 5);
+  g_assert_cmpuint (counters[0], ==, 5);
+  g_assert_cmpuint (counters[1], ==, 0);
+
+  /* Released rows are no longer children of the view, but stay set up */
+  gtk_string_list_splice (list, 0, 5, NULL);
+  g_assert_cmpuint (count_rows (view), ==, 0);
+  g_assert_cmpuint (counters[1], ==, 0);
+
+  /* New rows reuse the released ones */
+  gtk_string_list_splice (list, 0, 0, strings);
+  g_assert_cmpuint (count_rows (view), ==, 5);
+  g_assert_cmpuint (counters[0], ==, 5);
+  g_assert_cmpuint (counters[1], ==, 0);
+
+  /* Pooled rows get torn down with the view */
+  gtk_string_list_splice (list, 0, 5, NULL);
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_assert_cmpuint (counters[0], ==, 5);
+  g_assert_cmpuint (counters[1], ==, 5);
+
+  g_object_unref (list);
+}
+
+static void
+setup_label_cb (GtkSignalListItemFactory *factory,
+                GtkListItem              *list_item)
+{
+  gtk_list_item_set_child (list_item, gtk_label_new (NULL));
+}
+
+static void
+bind_label_cb (GtkSignalListItemFactory *factory,
+               GtkListItem              *list_item)
+{
+  GtkStringObject *object = gtk_list_item_get_item (list_item);
+
+  gtk_label_set_label (GTK_LABEL (gtk_list_item_get_child (list_item)),
+                       gtk_string_object_get_string (object));
+}
+
+/* Rows without a widget get the mean height of the measured rows */
+static int
+expected_height (GtkWidget *view,
+                 guint      n_items)
+{
+  GtkWidget *child;
+  guint n = 0;
+  int sum = 0, nat;
+
+  for (child = gtk_widget_get_first_child (view);
+       child != NULL;
+       child = gtk_widget_get_next_sibling (child))
+    {
+      if (!g_str_equal (gtk_widget_get_css_name (child), "row"))
+        continue;
+
+      gtk_widget_measure (child, GTK_ORIENTATION_VERTICAL, -1, NULL, &nat, NULL, NULL);
+      sum += nat;
+      n++;
+    }
+
+  g_assert_cmpuint (n, >, 0);
+  g_assert_cmpuint (n, <, n_items);
+
+  return sum + (n_items - n) * ((sum + n / 2) / n);
+}
+
+static void
+test_estimate_row_height (void)
+{
+  GtkListItemFactory *factory;
+  GtkStringList *list;
+  GtkWidget *window, *view, *row;
+  int min_width, nat_height;
+  guint i;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < 1000; i++)
+    gtk_string_list_append (list, i % 2 ? "tall\ntall\ntall" : "short");
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_label_cb), NULL);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_label_cb), NULL);
+  view = gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (list))),
+                            factory);
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), view);
+
+  /* before the first allocation */
+  gtk_widget_measure (view, GTK_ORIENTATION_VERTICAL, -1, NULL, &nat_height, NULL, NULL);
+  g_assert_cmpint (nat_height, ==, expected_height (view, 1000));
+
+  /* the allocation uses the same estimate */
+  gtk_widget_measure (view, GTK_ORIENTATION_HORIZONTAL, -1, &min_width, NULL, NULL, NULL);
+  gtk_widget_size_allocate (view,
+                            &(GtkAllocation) { 0, 0, MAX (min_width, 200), nat_height },
+                            -1);
+  gtk_widget_measure (view, GTK_ORIENTATION_VERTICAL, -1, NULL, &nat_height, NULL, NULL);
+  g_assert_cmpint (nat_height, ==, expected_height (view, 1000));
+
+  /* allocating again doesn't count the rows twice */
+  gtk_widget_size_allocate (view,
+                            &(GtkAllocation) { 0, 0, MAX (min_width, 200), nat_height },
+                            -1);
+  gtk_widget_measure (view, GTK_ORIENTATION_VERTICAL, -1, NULL, &nat_height, NULL, NULL);
+  g_assert_cmpint (nat_height, ==, expected_height (view, 1000));
+
+  /* rows that change their height are counted again */
+  for (row = gtk_widget_get_first_child (view);
+       !g_str_equal (gtk_widget_get_css_name (row), "row");
+       row = gtk_widget_get_next_sibling (row))
+    { /* do nothing */ }
+  gtk_label_set_label (GTK_LABEL (gtk_widget_get_first_child (row)), "taller\ntaller\ntaller\ntaller");
+  gtk_widget_size_allocate (view,
+                            &(GtkAllocation) { 0, 0, MAX (min_width, 200), nat_height },
+                            -1);
+  gtk_widget_measure (view, GTK_ORIENTATION_VERTICAL, -1, NULL, &nat_height, NULL, NULL);
+  g_assert_cmpint (nat_height, ==, expected_height (view, 1000));
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+static gpointer
+count_prepare_func (gpointer      item,
+                    GCancellable *cancellable,
+                    gpointer      user_data)
+{
+  g_atomic_int_inc ((int *) user_data);
+
+  return NULL;
+}
+
+/* Sampling row heights in idle time neither leaves rows behind
+ * nor prepares the sampled items.
+ */
+static void
+test_sample_rows (void)
+{
+  GtkListItemFactory *factory;
+  GtkStringList *list;
+  GtkWidget *window, *view, *first;
+  int min_width, nat_height;
+  int n_prepared = 0;
+  guint i, n_rows;
+
+  list = gtk_string_list_new (NULL);
+  for (i = 0; i < 1000; i++)
+    gtk_string_list_append (list, i % 2 ? "tall\ntall\ntall" : "short");
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_label_cb), NULL);
+  g_signal_connect (factory, "bind", G_CALLBACK (bind_label_cb), NULL);
+  gtk_signal_list_item_factory_set_prepare_func (GTK_SIGNAL_LIST_ITEM_FACTORY (factory),
+                                                 count_prepare_func, NULL,
+                                                 &n_prepared, NULL);
+  view = gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (list))),
+                            factory);
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), view);
+
+  gtk_widget_measure (view, GTK_ORIENTATION_HORIZONTAL, -1, &min_width, NULL, NULL, NULL);
+  gtk_widget_measure (view, GTK_ORIENTATION_VERTICAL, -1, NULL, &nat_height, NULL, NULL);
+  gtk_widget_size_allocate (view,
+                            &(GtkAllocation) { 0, 0, MAX (min_width, 200), 200 },
+                            -1);
+  first = gtk_widget_get_first_child (view);
+  n_rows = count_rows (view);
+
+  while (g_atomic_int_get (&n_prepared) < n_rows)
+    g_main_context_iteration (NULL, TRUE);
+  while (g_main_context_iteration (NULL, FALSE));
+
+  g_assert_true (gtk_widget_get_first_child (view) == first);
+  g_assert_cmpuint (count_rows (view), ==, n_rows);
+  g_assert_cmpint (g_atomic_int_get (&n_prepared), ==, n_rows);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+}
+
+typedef struct {
+  GMutex lock;
+  GCond cond;
+  gboolean open;
+  int n_cancelled;
+  GString *log;
+} PrepareTest;
+
+static gpointer
+prepare_func (gpointer      item,
+              GCancellable *cancellable,
+              gpointer      user_data)
+{
+  PrepareTest *test = user_data;
+
+  g_mutex_lock (&test->lock);
+  while (!test->open)
+    g_cond_wait (&test->cond, &test->lock);
+  g_mutex_unlock (&test->lock);
+
+  if (g_cancellable_is_cancelled (cancellable))
+    {
+      g_atomic_int_inc (&test->n_cancelled);
+      return NULL;
+    }
+
+  return g_strdup_printf ("prepared %s", gtk_string_object_get_string (item));
+}
+
+static void
+prepare_log (GtkSignalListItemFactory *factory,
+             GtkListItem              *list_item,
+             const char               *what,
+             PrepareTest              *test)
+{
+  const char *data;
+
+  data = gtk_signal_list_item_factory_get_prepared_data (factory, list_item);
+  if (test->log->len)
+    g_string_append (test->log, ", ");
+  g_string_append_printf (test->log, "%s %s", what,
+                          gtk_string_object_get_string (gtk_list_item_get_item (list_item)));
+  if (data)
+    g_string_append_printf (test->log, ": %s", data);
+}
+
+static void
+prepare_bind_cb (GtkSignalListItemFactory *factory,
+                 GtkListItem              *list_item,
+                 PrepareTest              *test)
+{
+  prepare_log (factory, list_item, "bind", test);
+}
+
+static void
+prepare_unbind_cb (GtkSignalListItemFactory *factory,
+                   GtkListItem              *list_item,
+                   PrepareTest              *test)
+{
+  prepare_log (factory, list_item, "unbind", test);
+}
+
+static void
+prepare_test_open (PrepareTest *test)
+{
+  g_mutex_lock (&test->lock);
+  test->open = TRUE;
+  g_cond_broadcast (&test->cond);
+  g_mutex_unlock (&test->lock);
+}
+
+static GtkWidget *
+prepare_test_init (PrepareTest   *test,
+                   GtkStringList *list,
+                   gboolean       open)
+{
+  GtkListItemFactory *factory;
+  GtkWidget *window;
+
+  g_mutex_init (&test->lock);
+  g_cond_init (&test->cond);
+  test->open = open;
+  test->n_cancelled = 0;
+  test->log = g_string_new (NULL);
+
+  factory = gtk_signal_list_item_factory_new ();
+  g_signal_connect (factory, "setup", G_CALLBACK (setup_label_cb), NULL);
+  g_signal_connect (factory, "bind", G_CALLBACK (prepare_bind_cb), test);
+  g_signal_connect (factory, "unbind", G_CALLBACK (prepare_unbind_cb), test);
+  gtk_signal_list_item_factory_set_prepare_func (GTK_SIGNAL_LIST_ITEM_FACTORY (factory),
+                                                 prepare_func, g_free,
+                                                 test, NULL);
+
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window),
+                        gtk_list_view_new (GTK_SELECTION_MODEL (gtk_no_selection_new (G_LIST_MODEL (g_object_ref (list)))),
+                                           factory));
+
+  return window;
+}
+
+static void
+prepare_test_wait (PrepareTest *test,
+                   const char  *log)
+{
+  while (!g_str_has_suffix (test->log->str, log))
+    g_main_context_iteration (NULL, TRUE);
+}
+
+static void
+prepare_test_finish (PrepareTest *test,
+                     GtkWidget   *window)
+{
+  prepare_test_open (test);
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_string_free (test->log, TRUE);
+  g_cond_clear (&test->cond);
+  g_mutex_clear (&test->lock);
+}
+
+static void
+test_prepare (void)
+{
+  const char *strings[] = { "a", NULL };
+  GtkStringList *list;
+  GtkWidget *window;
+  PrepareTest test;
+
+  list = gtk_string_list_new (strings);
+  window = prepare_test_init (&test, list, TRUE);
+
+  prepare_test_wait (&test, "bind a: prepared a");
+  g_assert_cmpstr (test.log->str, ==, "bind a, unbind a, bind a: prepared a");
+
+  prepare_test_finish (&test, window);
+  g_object_unref (list);
+}
+
+/* Binding another item cancels the prepare function and drops its result */
+static void
+test_prepare_rebind (void)
+{
+  const char *strings[] = { "a", NULL };
+  const char *other[] = { "b", NULL };
+  GtkStringList *list;
+  GtkWidget *window;
+  PrepareTest test;
+
+  list = gtk_string_list_new (strings);
+  window = prepare_test_init (&test, list, FALSE);
+  g_assert_cmpstr (test.log->str, ==, "bind a");
+  g_string_set_size (test.log, 0);
+
+  gtk_string_list_splice (list, 0, 1, other);
+  prepare_test_open (&test);
+
+  prepare_test_wait (&test, "bind b: prepared b");
+  while (g_atomic_int_get (&test.n_cancelled) == 0)
+    g_main_context_iteration (NULL, FALSE);
+  while (g_main_context_iteration (NULL, FALSE));
+
+  g_assert_cmpint (test.n_cancelled, ==, 1);
+  g_assert_null (strstr (test.log->str, "prepared a"));
+
+  prepare_test_finish (&test, window);
+  g_object_unref (list);
+}
+
+int
+main (int argc, char *argv[])
+{
+  gtk_test_init (&argc, &argv);
+
+  g_test_add_func ("/listview/pool-reuse", test_pool_reuse);
+  g_test_add_func ("/listview/estimate-row-height", test_estimate_row_height);
+  g_test_add_func ("/listview/sample-rows", test_sample_rows);
+  g_test_add_func ("/listview/prepare", test_prepare);
+  g_test_add_func ("/listview/prepare-rebind", test_prepare_rebind);
+
+  return g_test_run ();
+}
@@ -468,6 +468,88 @@ test_readd (void)
   g_object_unref (selection);
 }
 
+/* Test that large selections keep readded items selected, too */
+static void
+test_readd_large (void)
+{
+  GtkSelectionModel *selection;
+  GListStore *store;
+  gboolean ret;
+
+  store = new_store (1, 20000, 1);
+
+  selection = new_model (store);
+
+  ret = gtk_selection_model_select_all (selection);
+  g_assert_true (ret);
+  assert_selection_changes (selection, "0:20000");
+
+  g_list_model_items_changed (G_LIST_MODEL (store), 1, 3, 3);
+  assert_changes (selection, "1-3+3");
+  g_assert_true (gtk_selection_model_is_selected (selection, 0));
+  g_assert_true (gtk_selection_model_is_selected (selection, 1));
+  g_assert_true (gtk_selection_model_is_selected (selection, 3));
+  g_assert_true (gtk_selection_model_is_selected (selection, 4));
+
+  ret = gtk_selection_model_unselect_range (selection, 5, 19995);
+  g_assert_true (ret);
+  assert_selection (selection, "1 2 3 4 5");
+  assert_selection_changes (selection, "5:19995");
+
+  g_list_model_items_changed (G_LIST_MODEL (store), 0, 10, 10);
+  assert_changes (selection, "0-10+10");
+  assert_selection (selection, "1 2 3 4 5");
+
+  g_list_model_items_changed (G_LIST_MODEL (store), 100, 5, 5);
+  assert_changes (selection, "100-5+5");
+  assert_selection (selection, "1 2 3 4 5");
+
+  g_object_unref (store);
+  g_object_unref (selection);
+}
+
+/* Test that without tracking items, large selections still work
+ * by position, but readded items are unselected
+ */
+static void
+test_readd_untracked (void)
+{
+  GtkSelectionModel *selection;
+  GListStore *store;
+  gboolean ret;
+
+  store = new_store (1, 20000, 1);
+
+  selection = new_model (store);
+  gtk_multi_selection_set_track_items (GTK_MULTI_SELECTION (selection), FALSE);
+  g_assert_false (gtk_multi_selection_get_track_items (GTK_MULTI_SELECTION (selection)));
+
+  ret = gtk_selection_model_select_all (selection);
+  g_assert_true (ret);
+  assert_selection_changes (selection, "0:20000");
+
+  g_list_model_items_changed (G_LIST_MODEL (store), 1, 3, 3);
+  assert_changes (selection, "1-3+3");
+  g_assert_true (gtk_selection_model_is_selected (selection, 0));
+  g_assert_false (gtk_selection_model_is_selected (selection, 1));
+  g_assert_false (gtk_selection_model_is_selected (selection, 3));
+  g_assert_true (gtk_selection_model_is_selected (selection, 4));
+
+  ret = gtk_selection_model_unselect_range (selection, 5, 19995);
+  g_assert_true (ret);
+  assert_selection (selection, "1 5");
+  assert_selection_changes (selection, "5:19995");
+
+  /* tracking again picks up the current selection */
+  gtk_multi_selection_set_track_items (GTK_MULTI_SELECTION (selection), TRUE);
+  g_list_model_items_changed (G_LIST_MODEL (store), 0, 10, 10);
+  assert_changes (selection, "0-10+10");
+  assert_selection (selection, "1 5");
+
+  g_object_unref (store);
+  g_object_unref (selection);
+}
+
 static void
 test_set_selection (void)
 {
@@ -688,6 +770,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/multiselection/selection", test_selection);
   g_test_add_func ("/multiselection/select-range", test_select_range);
   g_test_add_func ("/multiselection/readd", test_readd);
+  g_test_add_func ("/multiselection/readd-large", test_readd_large);
+  g_test_add_func ("/multiselection/readd-untracked", test_readd_untracked);
   g_test_add_func ("/multiselection/set_selection", test_set_selection);
   g_test_add_func ("/multiselection/selection-filter", test_selection_filter);
   g_test_add_func ("/multiselection/set-model", test_set_model);
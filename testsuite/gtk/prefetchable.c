@@ -0,0 +1,284 @@
+#include <locale.h>
+
+#include <gtk/gtk.h>
+
+static GQuark number_quark;
+
+/* A model that records the prefetches it gets */
+typedef struct _RecordModel RecordModel;
+typedef struct _RecordModelClass RecordModelClass;
+
+struct _RecordModel
+{
+  GObject parent_instance;
+
+  GListStore *store;
+  GString *prefetches;
+};
+
+struct _RecordModelClass
+{
+  GObjectClass parent_class;
+};
+
+static GType record_model_get_type (void);
+
+static GType
+record_model_get_item_type (GListModel *list)
+{
+  return G_TYPE_OBJECT;
+}
+
+static guint
+record_model_get_n_items (GListModel *list)
+{
+  RecordModel *self = (RecordModel *) list;
+
+  return g_list_model_get_n_items (G_LIST_MODEL (self->store));
+}
+
+static gpointer
+record_model_get_item (GListModel *list,
+                       guint       position)
+{
+  RecordModel *self = (RecordModel *) list;
+
+  return g_list_model_get_item (G_LIST_MODEL (self->store), position);
+}
+
+static void
+record_model_list_model_init (GListModelInterface *iface)
+{
+  iface->get_item_type = record_model_get_item_type;
+  iface->get_n_items = record_model_get_n_items;
+  iface->get_item = record_model_get_item;
+}
+
+static void
+record_model_prefetch (GtkPrefetchable *prefetchable,
+                       guint            position,
+                       guint            n_items)
+{
+  RecordModel *self = (RecordModel *) prefetchable;
+
+  if (self->prefetches->len > 0)
+    g_string_append (self->prefetches, ", ");
+  g_string_append_printf (self->prefetches, "%u:%u", position, n_items);
+}
+
+static void
+record_model_prefetchable_init (GtkPrefetchableInterface *iface)
+{
+  iface->prefetch = record_model_prefetch;
+}
+
+G_DEFINE_TYPE_WITH_CODE (RecordModel, record_model, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (G_TYPE_LIST_MODEL, record_model_list_model_init)
+                         G_IMPLEMENT_INTERFACE (GTK_TYPE_PREFETCHABLE, record_model_prefetchable_init))
+
+static void
+record_model_finalize (GObject *object)
+{
+  RecordModel *self = (RecordModel *) object;
+
+  g_object_unref (self->store);
+  g_string_free (self->prefetches, TRUE);
+
+  G_OBJECT_CLASS (record_model_parent_class)->finalize (object);
+}
+
+static void
+record_model_class_init (RecordModelClass *class)
+{
+  G_OBJECT_CLASS (class)->finalize = record_model_finalize;
+}
+
+static void
+record_model_init (RecordModel *self)
+{
+  self->store = g_list_store_new (G_TYPE_OBJECT);
+  self->prefetches = g_string_new (NULL);
+}
+
+static RecordModel *
+record_model_new (guint n_items)
+{
+  RecordModel *self;
+  guint i;
+
+  self = g_object_new (record_model_get_type (), NULL);
+
+  for (i = 0; i < n_items; i++)
+    {
+      GObject *object = g_object_new (G_TYPE_OBJECT, NULL);
+      g_object_set_qdata (object, number_quark, GUINT_TO_POINTER (i));
+      g_list_store_append (self->store, object);
+      g_object_unref (object);
+    }
+
+  return self;
+}
+
+static guint
+get_number (gpointer item)
+{
+  return GPOINTER_TO_UINT (g_object_get_qdata (item, number_quark));
+}
+
+#define assert_prefetches(model, expected) G_STMT_START{ \
+  RecordModel *_model = (model); \
+  if (!g_str_equal (_model->prefetches->str, expected)) \
+    g_assertion_message_cmpstr (G_LOG_DOMAIN, __FILE__, __LINE__, G_STRFUNC, \
+        #model " == " #expected, _model->prefetches->str, "==", expected); \
+  g_string_set_size (_model->prefetches, 0); \
+}G_STMT_END
+
+static gboolean
+is_multiple_of_three (gpointer item,
+                      gpointer user_data)
+{
+  return get_number (item) % 3 == 0;
+}
+
+static gboolean
+match_nothing (gpointer item,
+               gpointer user_data)
+{
+  return FALSE;
+}
+
+static int
+compare_odd_last (gconstpointer a,
+                  gconstpointer b,
+                  gpointer      user_data)
+{
+  guint na = get_number ((gpointer) a);
+  guint nb = get_number ((gpointer) b);
+
+  if (na % 2 != nb % 2)
+    return na % 2 < nb % 2 ? -1 : 1;
+
+  return na < nb ? -1 : (na > nb ? 1 : 0);
+}
+
+static void
+test_prefetch (void)
+{
+  RecordModel *model;
+
+  model = record_model_new (20);
+
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (model), 3, 5);
+  assert_prefetches (model, "3:5");
+
+  /* empty ranges are not passed on */
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (model), 3, 0);
+  assert_prefetches (model, "");
+
+  g_object_unref (model);
+}
+
+static void
+test_filter (void)
+{
+  RecordModel *model;
+  GtkFilterListModel *filter;
+  GtkFilter *custom;
+
+  model = record_model_new (20);
+  filter = gtk_filter_list_model_new (g_object_ref (G_LIST_MODEL (model)), NULL);
+
+  /* no filter forwards the range unchanged */
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (filter), 2, 5);
+  assert_prefetches (model, "2:5");
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (filter), 18, 5);
+  assert_prefetches (model, "18:2");
+
+  /* 0 3 6 9 12 15 18 */
+  custom = GTK_FILTER (gtk_custom_filter_new (is_multiple_of_three, NULL, NULL));
+  gtk_filter_list_model_set_filter (filter, custom);
+  g_object_unref (custom);
+
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (filter), 1, 2);
+  assert_prefetches (model, "3:4");
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (filter), 5, 10);
+  assert_prefetches (model, "15:4");
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (filter), 7, 1);
+  assert_prefetches (model, "");
+
+  custom = GTK_FILTER (gtk_custom_filter_new (match_nothing, NULL, NULL));
+  gtk_filter_list_model_set_filter (filter, custom);
+  g_object_unref (custom);
+
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (filter), 0, 5);
+  assert_prefetches (model, "");
+
+  g_object_unref (filter);
+  g_object_unref (model);
+}
+
+static void
+test_slice (void)
+{
+  RecordModel *model;
+  GtkSliceListModel *slice;
+
+  model = record_model_new (20);
+  slice = gtk_slice_list_model_new (g_object_ref (G_LIST_MODEL (model)), 5, 10);
+
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (slice), 2, 3);
+  assert_prefetches (model, "7:3");
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (slice), 8, 5);
+  assert_prefetches (model, "13:2");
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (slice), 10, 1);
+  assert_prefetches (model, "");
+
+  /* the slice reaches past the end of the model */
+  gtk_slice_list_model_set_offset (slice, 15);
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (slice), 2, 5);
+  assert_prefetches (model, "17:3");
+
+  g_object_unref (slice);
+  g_object_unref (model);
+}
+
+static void
+test_sort (void)
+{
+  RecordModel *model;
+  GtkSortListModel *sort;
+  GtkSorter *sorter;
+
+  /* 0 2 4 ... 18 1 3 ... 19 */
+  model = record_model_new (20);
+  sorter = GTK_SORTER (gtk_custom_sorter_new (compare_odd_last, NULL, NULL));
+  sort = gtk_sort_list_model_new (g_object_ref (G_LIST_MODEL (model)), sorter);
+
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (sort), 0, 3);
+  assert_prefetches (model, "0:5");
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (sort), 11, 2);
+  assert_prefetches (model, "3:3");
+
+  /* items from both ends of the model are not worth a prefetch */
+  gtk_prefetchable_prefetch (GTK_PREFETCHABLE (sort), 9, 2);
+  assert_prefetches (model, "");
+
+  g_object_unref (sort);
+  g_object_unref (model);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  number_quark = g_quark_from_static_string ("Like a trail of blood across the sky");
+
+  g_test_add_func ("/prefetchable/prefetch", test_prefetch);
+  g_test_add_func ("/prefetchable/filter", test_filter);
+  g_test_add_func ("/prefetchable/slice", test_slice);
+  g_test_add_func ("/prefetchable/sort", test_sort);
+
+  return g_test_run ();
+}
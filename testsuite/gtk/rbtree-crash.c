@@ -101,6 +101,16 @@ add (GtkRbTree *tree,
   gtk_rb_tree_insert_before (tree, node);
 }
 
+static void
+add_many (GtkRbTree *tree,
+          guint      pos,
+          gsize      n)
+{
+  Node *node = get (tree, pos);
+
+  gtk_rb_tree_insert_many_before (tree, node, n);
+}
+
 static void
 delete (GtkRbTree *tree,
         guint      pos)
@@ -289,6 +299,62 @@ test_crash2 (void)
   gtk_rb_tree_unref (tree);
 }
 
+static guint
+get_n_items (GtkRbTree *tree)
+{
+  Node *root;
+  Aug *aug;
+
+  root = gtk_rb_tree_get_root (tree);
+  if (root == NULL)
+    return 0;
+
+  aug = gtk_rb_tree_get_augment (tree, root);
+  return aug->n_items;
+}
+
+static void
+test_insert_many (void)
+{
+  GtkRbTree *tree;
+  Node *node;
+  guint i;
+
+  tree = gtk_rb_tree_new (Node, Aug, augment, NULL, NULL);
+
+  /* build from scratch */
+  add_many (tree, 0, 1000);
+  g_assert_cmpuint (get_n_items (tree), ==, 1000);
+
+  /* few items, inserted one by one */
+  add_many (tree, 500, 3);
+  g_assert_cmpuint (get_n_items (tree), ==, 1003);
+
+  /* many items, rebuilding the tree */
+  node = gtk_rb_tree_insert_many_before (tree, get (tree, 10), 2000);
+  for (i = 0; i < 2000; i++)
+    {
+      g_assert_nonnull (node);
+      node->unused = i + 1;
+      node = gtk_rb_tree_node_get_next (node);
+    }
+  g_assert_cmpuint (get_n_items (tree), ==, 3003);
+  for (i = 0; i < 2000; i++)
+    g_assert_cmpuint (get (tree, 10 + i)->unused, ==, i + 1);
+  g_assert_cmpuint (get (tree, 9)->unused, ==, 0);
+  g_assert_cmpuint (get (tree, 2010)->unused, ==, 0);
+
+  /* the tree must still be valid for modifications */
+  for (i = 0; i < 1000; i++)
+    delete (tree, (i * 7) % get_n_items (tree));
+  for (i = 0; i < 1000; i++)
+    add (tree, (i * 13) % get_n_items (tree));
+  add_many (tree, get_n_items (tree), 5000);
+  g_assert_cmpuint (get_n_items (tree), ==, 8003);
+
+  gtk_rb_tree_unref (tree);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -297,6 +363,7 @@ main (int argc, char *argv[])
 
   g_test_add_func ("/rbtree/crash", test_crash);
   g_test_add_func ("/rbtree/crash2", test_crash2);
+  g_test_add_func ("/rbtree/insert-many", test_insert_many);
 
   return g_test_run ();
 }
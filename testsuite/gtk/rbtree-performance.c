@@ -0,0 +1,277 @@
+/* GtkRbTree performance tests.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <locale.h>
+
+#include <gtk/gtk.h>
+
+#include "gtk/gtkrbtreeprivate.h"
+
+/* Run with -m perf to get meaningful numbers */
+
+typedef struct _Node Node;
+typedef struct _Aug Aug;
+
+struct _Node {
+  guint n_items;
+};
+
+struct _Aug {
+  guint n_items;
+};
+
+static void
+augment (GtkRbTree *tree,
+         gpointer   _aug,
+         gpointer   _node,
+         gpointer   left,
+         gpointer   right)
+{
+  Node *node = _node;
+  Aug *aug = _aug;
+
+  aug->n_items = node->n_items;
+
+  if (left)
+    {
+      Aug *left_aug = gtk_rb_tree_get_augment (tree, left);
+
+      aug->n_items += left_aug->n_items;
+    }
+
+  if (right)
+    {
+      Aug *right_aug = gtk_rb_tree_get_augment (tree, right);
+
+      aug->n_items += right_aug->n_items;
+    }
+}
+
+static guint
+get_n_items (GtkRbTree *tree)
+{
+  Node *root;
+  Aug *aug;
+
+  root = gtk_rb_tree_get_root (tree);
+  if (root == NULL)
+    return 0;
+
+  aug = gtk_rb_tree_get_augment (tree, root);
+  return aug->n_items;
+}
+
+static Node *
+get_nth (GtkRbTree *tree,
+         guint      position)
+{
+  Node *node, *tmp;
+
+  node = gtk_rb_tree_get_root (tree);
+
+  while (node)
+    {
+      tmp = gtk_rb_tree_node_get_left (node);
+      if (tmp)
+        {
+          Aug *aug = gtk_rb_tree_get_augment (tree, tmp);
+          if (position < aug->n_items)
+            {
+              node = tmp;
+              continue;
+            }
+          position -= aug->n_items;
+        }
+
+      if (position < node->n_items)
+        break;
+      position -= node->n_items;
+
+      node = gtk_rb_tree_node_get_right (node);
+    }
+
+  return node;
+}
+
+static GtkRbTree *
+create_tree (guint n)
+{
+  GtkRbTree *tree;
+  Node *node;
+  guint i;
+
+  tree = gtk_rb_tree_new (Node, Aug, augment, NULL, NULL);
+
+  node = NULL;
+  for (i = 0; i < n; i++)
+    {
+      node = gtk_rb_tree_insert_after (tree, node);
+      node->n_items = 1;
+    }
+
+  return tree;
+}
+
+static void
+test_append (void)
+{
+  guint n = g_test_perf () ? 1000000 : 1000;
+  GtkRbTree *tree;
+  double elapsed;
+
+  g_test_timer_start ();
+
+  tree = create_tree (n);
+
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "appending %u nodes: %gsec", n, elapsed);
+
+  g_assert_cmpuint (get_n_items (tree), ==, n);
+
+  gtk_rb_tree_unref (tree);
+}
+
+static void
+test_insert_random (void)
+{
+  guint n = g_test_perf () ? 100000 : 1000;
+  GtkRbTree *tree;
+  Node *node;
+  double elapsed;
+  guint i;
+
+  tree = gtk_rb_tree_new (Node, Aug, augment, NULL, NULL);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n; i++)
+    {
+      node = get_nth (tree, g_test_rand_int_range (0, i + 1));
+      node = gtk_rb_tree_insert_before (tree, node);
+      node->n_items = 1;
+    }
+
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "inserting %u nodes at random positions: %gsec", n, elapsed);
+
+  g_assert_cmpuint (get_n_items (tree), ==, n);
+
+  gtk_rb_tree_unref (tree);
+}
+
+static void
+test_remove_insert (void)
+{
+  guint n = g_test_perf () ? 100000 : 1000;
+  GtkRbTree *tree;
+  Node *node;
+  double elapsed;
+  guint i;
+
+  tree = create_tree (n);
+
+  g_test_timer_start ();
+
+  /* This reuses freed nodes */
+  for (i = 0; i < n; i++)
+    {
+      gtk_rb_tree_remove (tree, get_nth (tree, g_test_rand_int_range (0, n)));
+      node = get_nth (tree, g_test_rand_int_range (0, n - 1));
+      node = gtk_rb_tree_insert_after (tree, node);
+      node->n_items = 1;
+    }
+
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "removing and inserting %u nodes: %gsec", n, elapsed);
+
+  g_assert_cmpuint (get_n_items (tree), ==, n);
+
+  gtk_rb_tree_unref (tree);
+}
+
+static void
+test_augment (void)
+{
+  guint n = g_test_perf () ? 1000000 : 1000;
+  guint n_runs = g_test_perf () ? 100 : 10;
+  GtkRbTree *tree;
+  Node *node;
+  double elapsed;
+  guint i;
+
+  tree = create_tree (n);
+  g_assert_cmpuint (get_n_items (tree), ==, n);
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_runs; i++)
+    {
+      /* dirty a path to the root and walk the tree to clean it */
+      node = get_nth (tree, g_test_rand_int_range (0, n));
+      node->n_items = 2;
+      gtk_rb_tree_node_mark_dirty (node);
+      g_assert_cmpuint (get_n_items (tree), ==, n + 1);
+      node->n_items = 1;
+      gtk_rb_tree_node_mark_dirty (node);
+      g_assert_cmpuint (get_n_items (tree), ==, n);
+    }
+
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "updating augments of %u nodes %u times: %gsec", n, n_runs, elapsed);
+
+  gtk_rb_tree_unref (tree);
+}
+
+static void
+test_teardown (void)
+{
+  guint n = g_test_perf () ? 1000000 : 1000;
+  GtkRbTree *tree;
+  double elapsed;
+
+  tree = create_tree (n);
+
+  g_test_timer_start ();
+
+  gtk_rb_tree_remove_all (tree);
+
+  elapsed = g_test_timer_elapsed ();
+  if (g_test_perf ())
+    g_test_minimized_result (elapsed, "removing all %u nodes: %gsec", n, elapsed);
+
+  g_assert_cmpuint (get_n_items (tree), ==, 0);
+
+  gtk_rb_tree_unref (tree);
+}
+
+int
+main (int argc, char *argv[])
+{
+  g_test_init (&argc, &argv, NULL);
+  setlocale (LC_ALL, "C");
+
+  g_test_add_func ("/rbtree/performance/append", test_append);
+  g_test_add_func ("/rbtree/performance/insert-random", test_insert_random);
+  g_test_add_func ("/rbtree/performance/remove-insert", test_remove_insert);
+  g_test_add_func ("/rbtree/performance/augment", test_augment);
+  g_test_add_func ("/rbtree/performance/teardown", test_teardown);
+
+  return g_test_run ();
+}
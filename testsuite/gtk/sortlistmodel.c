@@ -316,7 +316,7 @@ test_set_sorter (void)
   gtk_sort_list_model_set_sorter (sort, sorter);
   g_object_unref (sorter);
   assert_model (sort, "10 6 2 8 4");
-  assert_changes (sort, "0-5+5");
+  assert_changes (sort, "0+2, +3, 5-3");
 
   gtk_sort_list_model_set_sorter (sort, NULL);
   assert_model (sort, "4 8 2 6 10");
@@ -326,7 +326,7 @@ test_set_sorter (void)
   gtk_sort_list_model_set_sorter (sort, sorter);
   g_object_unref (sorter);
   assert_model (sort, "2 4 6 8 10");
-  assert_changes (sort, "0-4+4");
+  assert_changes (sort, "+0, +2, 4-2");
 
   g_object_unref (store);
   g_object_unref (sort);
@@ -428,7 +428,7 @@ test_stability (void)
   gtk_sort_list_model_set_sorter (sort, sorter);
   g_object_unref (sorter);
   assert_model (sort, "11 31 21 1");
-  assert_changes (sort, "0-4+4");
+  assert_changes (sort, "-0, +1, 3-1+1");
 
   g_object_unref (store);
   g_object_unref (sort);
@@ -517,6 +517,378 @@ test_incremental_remove (void)
   g_object_unref (removed);
 }
 
+static guint
+get_number (gpointer object)
+{
+  return GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark));
+}
+
+/* Test that threaded sorting produces the same result as a
+ * regular sort and survives changes while the threads run.
+ */
+static void
+test_threaded (void)
+{
+  GListStore *store;
+  GtkSortListModel *model;
+  GtkSorter *sorter;
+  GtkExpression *expression;
+  guint i;
+  const guint n_items = 100000;
+
+  store = new_shuffled_store (n_items);
+  model = new_model (NULL);
+  gtk_sort_list_model_set_threaded (model, TRUE);
+  g_assert_true (gtk_sort_list_model_get_threaded (model));
+
+  expression = gtk_cclosure_expression_new (G_TYPE_UINT, NULL, 0, NULL, G_CALLBACK (get_number), NULL, NULL);
+  sorter = GTK_SORTER (gtk_numeric_sorter_new (gtk_expression_ref (expression)));
+  gtk_sort_list_model_set_sorter (model, sorter);
+  g_object_unref (sorter);
+
+  gtk_sort_list_model_set_model (model, G_LIST_MODEL (store));
+  /* the sort happens in a thread, so nothing is sorted yet */
+  g_assert_cmpuint (gtk_sort_list_model_get_pending (model), >, 0);
+
+  /* remove some items while the sort is ongoing */
+  g_list_store_splice (store, 0, 10, NULL, 0);
+  g_assert_cmpuint (gtk_sort_list_model_get_pending (model), >, 0);
+
+  while (gtk_sort_list_model_get_pending (model) != 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, n_items - 10);
+  for (i = 1; i < g_list_model_get_n_items (G_LIST_MODEL (model)); i++)
+    g_assert_cmpuint (get (G_LIST_MODEL (model), i - 1), <, get (G_LIST_MODEL (model), i));
+
+  /* disabling threading finishes the sort right away */
+  gtk_sort_list_model_set_sorter (model, NULL);
+  sorter = GTK_SORTER (gtk_numeric_sorter_new (gtk_expression_ref (expression)));
+  gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (sorter), GTK_SORT_DESCENDING);
+  gtk_sort_list_model_set_sorter (model, sorter);
+  g_object_unref (sorter);
+  gtk_sort_list_model_set_threaded (model, FALSE);
+  g_assert_cmpuint (gtk_sort_list_model_get_pending (model), ==, 0);
+  for (i = 1; i < g_list_model_get_n_items (G_LIST_MODEL (model)); i++)
+    g_assert_cmpuint (get (G_LIST_MODEL (model), i - 1), >, get (G_LIST_MODEL (model), i));
+
+  ignore_changes (model);
+
+  gtk_expression_unref (expression);
+  g_object_unref (store);
+  g_object_unref (model);
+}
+
+static guint
+get_number_div_ten (gpointer  object,
+                    guint    *n_calls)
+{
+  (*n_calls)++;
+
+  return GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark)) / 10;
+}
+
+static guint
+get_number_counted (gpointer  object,
+                    guint    *n_calls)
+{
+  (*n_calls)++;
+
+  return GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark));
+}
+
+/* Test that inverting the sort order keeps the keys and keeps
+ * equal items in their original order.
+ */
+static void
+test_invert (void)
+{
+  GtkSortListModel *sort;
+  GListStore *store;
+  GtkSorter *sorter;
+  guint n_calls = 0;
+
+  store = new_store ((guint[]) { 11, 31, 21, 1, 12, 22, 2, 0 });
+  sort = new_model (store);
+  ignore_changes (sort);
+
+  sorter = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT, NULL, 0, NULL,
+                                                                            G_CALLBACK (get_number_div_ten),
+                                                                            &n_calls, NULL)));
+  gtk_sort_list_model_set_sorter (sort, sorter);
+  assert_model (sort, "1 2 11 12 21 22 31");
+  ignore_changes (sort);
+  g_assert_cmpuint (n_calls, ==, 7);
+
+  gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (sorter), GTK_SORT_DESCENDING);
+  assert_model (sort, "31 21 22 11 12 1 2");
+  assert_changes (sort, "0-7+7");
+  g_assert_cmpuint (n_calls, ==, 7);
+
+  gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (sorter), GTK_SORT_ASCENDING);
+  assert_model (sort, "1 2 11 12 21 22 31");
+  assert_changes (sort, "0-7+7");
+  g_assert_cmpuint (n_calls, ==, 7);
+
+  g_object_unref (sorter);
+  g_object_unref (store);
+  g_object_unref (sort);
+}
+
+/* Test that adding and removing sorters of a multi sorter only
+ * creates keys for the sorters that were added.
+ */
+static void
+test_multi_keys (void)
+{
+  GtkSortListModel *sort;
+  GListStore *store;
+  GtkMultiSorter *multi;
+  GtkSorter *sorter;
+  guint n_calls1 = 0, n_calls2 = 0;
+
+  store = new_store ((guint[]) { 11, 31, 21, 1, 12, 22, 2, 0 });
+  sort = new_model (store);
+  ignore_changes (sort);
+
+  multi = gtk_multi_sorter_new ();
+  gtk_multi_sorter_append (multi, GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT, NULL, 0, NULL,
+                                                                                                   G_CALLBACK (get_number_div_ten),
+                                                                                                   &n_calls1, NULL))));
+  gtk_sort_list_model_set_sorter (sort, GTK_SORTER (multi));
+  assert_model (sort, "1 2 11 12 21 22 31");
+  ignore_changes (sort);
+  g_assert_cmpuint (n_calls1, ==, 7);
+
+  sorter = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT, NULL, 0, NULL,
+                                                                            G_CALLBACK (get_number_counted),
+                                                                            &n_calls2, NULL)));
+  gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (sorter), GTK_SORT_DESCENDING);
+  gtk_multi_sorter_append (multi, sorter);
+  assert_model (sort, "2 1 12 11 22 21 31");
+  ignore_changes (sort);
+  g_assert_cmpuint (n_calls1, ==, 7);
+  g_assert_cmpuint (n_calls2, ==, 7);
+
+  gtk_multi_sorter_remove (multi, 0);
+  assert_model (sort, "31 22 21 12 11 2 1");
+  ignore_changes (sort);
+  g_assert_cmpuint (n_calls1, ==, 7);
+  g_assert_cmpuint (n_calls2, ==, 7);
+
+  g_object_unref (multi);
+  g_object_unref (store);
+  g_object_unref (sort);
+}
+
+/* Test that resorting only removes and adds the items that moved */
+static void
+test_resort_moves (void)
+{
+  GtkSortListModel *sort;
+  GListStore *store;
+  GtkSorter *sorter;
+  GObject *object;
+
+  store = new_store ((guint[]) { 4, 8, 2, 6, 10, 9, 7, 5, 3, 1, 0 });
+  sorter = GTK_SORTER (gtk_custom_sorter_new (compare, NULL, NULL));
+  sort = new_model (NULL);
+  gtk_sort_list_model_set_model (sort, G_LIST_MODEL (store));
+  gtk_sort_list_model_set_sorter (sort, sorter);
+  assert_model (sort, "1 2 3 4 5 6 7 8 9 10");
+  ignore_changes (sort);
+
+  object = g_list_model_get_item (G_LIST_MODEL (store), 2);
+  g_object_set_qdata (object, number_quark, GUINT_TO_POINTER (35));
+  gtk_sorter_changed (sorter, GTK_SORTER_CHANGE_DIFFERENT);
+  assert_model (sort, "1 3 4 5 6 7 8 9 10 35");
+  assert_changes (sort, "-1, +9");
+
+  g_object_set_qdata (object, number_quark, GUINT_TO_POINTER (2));
+  gtk_sorter_changed (sorter, GTK_SORTER_CHANGE_DIFFERENT);
+  assert_model (sort, "1 2 3 4 5 6 7 8 9 10");
+  assert_changes (sort, "+1, -10");
+
+  g_object_unref (object);
+  g_object_unref (sorter);
+  g_object_unref (store);
+  g_object_unref (sort);
+}
+
+static void
+mirror_items_changed (GListModel *model,
+                      guint       position,
+                      guint       removed,
+                      guint       added,
+                      GListStore *mirror)
+{
+  gpointer *items = g_newa (gpointer, added);
+  guint i;
+
+  for (i = 0; i < added; i++)
+    items[i] = g_list_model_get_item (model, position + i);
+
+  g_list_store_splice (mirror, position, removed, items, added);
+
+  for (i = 0; i < added; i++)
+    g_object_unref (items[i]);
+}
+
+static void
+resort_again (GListModel *model,
+              guint       position,
+              guint       removed,
+              guint       added,
+              GObject    *object)
+{
+  GtkSorter *sorter = gtk_sort_list_model_get_sorter (GTK_SORT_LIST_MODEL (model));
+
+  g_signal_handlers_disconnect_by_func (model, resort_again, object);
+
+  g_object_set_qdata (object, number_quark, GUINT_TO_POINTER (2));
+  gtk_sorter_changed (sorter, GTK_SORTER_CHANGE_DIFFERENT);
+}
+
+/* Test that changing the model while a resort is emitted keeps
+ * the signals consistent with the contents of the model
+ */
+static void
+test_resort_reentrant (void)
+{
+  GtkSortListModel *sort;
+  GListStore *store, *mirror;
+  GtkSorter *sorter;
+  GObject *object;
+
+  store = new_store ((guint[]) { 4, 8, 2, 6, 10, 9, 7, 5, 3, 1, 0 });
+  sorter = GTK_SORTER (gtk_custom_sorter_new (compare, NULL, NULL));
+  sort = new_model (NULL);
+  gtk_sort_list_model_set_model (sort, G_LIST_MODEL (store));
+  gtk_sort_list_model_set_sorter (sort, sorter);
+  assert_model (sort, "1 2 3 4 5 6 7 8 9 10");
+  ignore_changes (sort);
+
+  mirror = new_empty_store ();
+  mirror_items_changed (G_LIST_MODEL (sort), 0, 0, g_list_model_get_n_items (G_LIST_MODEL (sort)), mirror);
+  g_signal_connect (sort, "items-changed", G_CALLBACK (mirror_items_changed), mirror);
+
+  object = g_list_model_get_item (G_LIST_MODEL (store), 2);
+  g_signal_connect (sort, "items-changed", G_CALLBACK (resort_again), object);
+  g_object_set_qdata (object, number_quark, GUINT_TO_POINTER (35));
+  gtk_sorter_changed (sorter, GTK_SORTER_CHANGE_DIFFERENT);
+
+  assert_model (sort, "1 2 3 4 5 6 7 8 9 10");
+  assert_model (mirror, "1 2 3 4 5 6 7 8 9 10");
+  ignore_changes (sort);
+
+  g_signal_handlers_disconnect_by_func (sort, mirror_items_changed, mirror);
+  g_object_unref (mirror);
+  g_object_unref (object);
+  g_object_unref (sorter);
+  g_object_unref (store);
+  g_object_unref (sort);
+}
+
+/* Test that replacing a single item only moves that item */
+static void
+test_item_changed (void)
+{
+  GtkSortListModel *sort;
+  GListStore *store;
+  GObject *object;
+
+  store = new_store ((guint[]) { 4, 8, 2, 6, 10, 0 });
+  sort = new_model (store);
+  assert_model (sort, "2 4 6 8 10");
+  assert_changes (sort, "");
+
+  splice (store, 1, 1, (guint[]) { 5 }, 1);
+  assert_model (sort, "2 4 5 6 10");
+  assert_changes (sort, "-3, +2");
+
+  /* changing the item itself */
+  object = g_list_model_get_item (G_LIST_MODEL (store), 0);
+  g_object_set_qdata (object, number_quark, GUINT_TO_POINTER (20));
+  g_list_store_splice (store, 0, 1, (gpointer *) &object, 1);
+  g_object_unref (object);
+  assert_model (sort, "2 5 6 10 20");
+  assert_changes (sort, "-1, +4");
+
+  splice (store, 3, 1, (guint[]) { 7 }, 1);
+  assert_model (sort, "2 5 7 10 20");
+  assert_changes (sort, "2-1+1");
+
+  g_object_unref (store);
+  g_object_unref (sort);
+}
+
+static char *
+get_string_div_ten (gpointer object)
+{
+  return g_strdup_printf ("item %06u", GPOINTER_TO_UINT (g_object_get_qdata (object, number_quark)) / 10);
+}
+
+static void
+assert_sorted_like_incremental (GListStore *store,
+                                GtkSorter  *sorter)
+{
+  GtkSortListModel *model, *reference;
+  guint i;
+
+  model = gtk_sort_list_model_new (g_object_ref (G_LIST_MODEL (store)), g_object_ref (sorter));
+  g_assert_cmpuint (gtk_sort_list_model_get_pending (model), ==, 0);
+
+  /* incremental sorting never sorts by key prefix */
+  reference = gtk_sort_list_model_new (NULL, g_object_ref (sorter));
+  gtk_sort_list_model_set_incremental (reference, TRUE);
+  gtk_sort_list_model_set_model (reference, G_LIST_MODEL (store));
+  while (gtk_sort_list_model_get_pending (reference) != 0)
+    g_main_context_iteration (NULL, TRUE);
+
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (model)), ==, g_list_model_get_n_items (G_LIST_MODEL (store)));
+  for (i = 0; i < g_list_model_get_n_items (G_LIST_MODEL (model)); i++)
+    g_assert_cmpuint (get (G_LIST_MODEL (model), i), ==, get (G_LIST_MODEL (reference), i));
+
+  g_object_unref (reference);
+  g_object_unref (model);
+}
+
+/* Test that sorting by key prefixes gives the same result as
+ * comparing, including the order of equal items.
+ */
+static void
+test_prefix (void)
+{
+  GListStore *store;
+  GtkSorter *sorter;
+  guint n_calls = 0;
+
+  store = new_shuffled_store (20000);
+
+  sorter = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT, NULL, 0, NULL,
+                                                                            G_CALLBACK (get_number),
+                                                                            NULL, NULL)));
+  assert_sorted_like_incremental (store, sorter);
+  gtk_numeric_sorter_set_sort_order (GTK_NUMERIC_SORTER (sorter), GTK_SORT_DESCENDING);
+  assert_sorted_like_incremental (store, sorter);
+  g_object_unref (sorter);
+
+  sorter = GTK_SORTER (gtk_numeric_sorter_new (gtk_cclosure_expression_new (G_TYPE_UINT, NULL, 0, NULL,
+                                                                            G_CALLBACK (get_number_div_ten),
+                                                                            &n_calls, NULL)));
+  assert_sorted_like_incremental (store, sorter);
+  g_object_unref (sorter);
+
+  /* strings share their first 8 bytes, so ties need comparing */
+  sorter = GTK_SORTER (gtk_string_sorter_new (gtk_cclosure_expression_new (G_TYPE_STRING, NULL, 0, NULL,
+                                                                           G_CALLBACK (get_string_div_ten),
+                                                                           NULL, NULL)));
+  assert_sorted_like_incremental (store, sorter);
+  g_object_unref (sorter);
+
+  g_object_unref (store);
+}
+
 static void
 test_out_of_bounds_access (void)
 {
@@ -553,6 +925,13 @@ main (int argc, char *argv[])
 #endif
   g_test_add_func ("/sortlistmodel/stability", test_stability);
   g_test_add_func ("/sortlistmodel/incremental/remove", test_incremental_remove);
+  g_test_add_func ("/sortlistmodel/threaded", test_threaded);
+  g_test_add_func ("/sortlistmodel/invert", test_invert);
+  g_test_add_func ("/sortlistmodel/multi-keys", test_multi_keys);
+  g_test_add_func ("/sortlistmodel/prefix", test_prefix);
+  g_test_add_func ("/sortlistmodel/resort-moves", test_resort_moves);
+  g_test_add_func ("/sortlistmodel/resort-reentrant", test_resort_reentrant);
+  g_test_add_func ("/sortlistmodel/item-changed", test_item_changed);
   g_test_add_func ("/sortlistmodel/oob-access", test_out_of_bounds_access);
 
   return g_test_run ();
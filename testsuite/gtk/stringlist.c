@@ -242,6 +242,119 @@ test_take (void)
   g_object_unref (list);
 }
 
+static void
+test_splice_bytes (void)
+{
+  GtkStringList *list;
+  GBytes *bytes;
+
+  list = new_model ((const char *[]){ "a", "b", "c", NULL });
+
+  bytes = g_bytes_new_static ("x\0\0y\0", 5);
+  gtk_string_list_splice_bytes (list, 1, 1, bytes);
+  g_bytes_unref (bytes);
+
+  assert_model (list, "a x  y c");
+  assert_changes (list, "1-1+3");
+
+  g_object_unref (list);
+}
+
+static void
+test_take_lines (void)
+{
+  GtkStringList *list;
+
+  list = new_model ((const char *[]){ "a", NULL });
+
+  gtk_string_list_splice_take_lines (list, 1, 0, g_strdup ("x\ny\nz\n"), -1);
+  assert_model (list, "a x y z");
+  assert_changes (list, "1+3");
+
+  /* the last line doesn't need to end with a newline */
+  gtk_string_list_splice_take_lines (list, 0, 1, g_strdup ("b\n\nc"), -1);
+  assert_model (list, "b  c x y z");
+  assert_changes (list, "0-1+3");
+
+  g_object_unref (list);
+}
+
+static void
+test_objects (void)
+{
+  GtkStringList *list;
+  GtkStringObject *so1, *so2;
+
+  list = new_model ((const char *[]){ "a", "b", "c", NULL });
+
+  /* items keep their identity even when nobody holds a reference */
+  so1 = g_list_model_get_item (G_LIST_MODEL (list), 2);
+  g_object_set_data (G_OBJECT (so1), "test-data", list);
+  g_object_unref (so1);
+  so2 = g_list_model_get_item (G_LIST_MODEL (list), 2);
+  g_assert_true (so1 == so2);
+  g_assert_true (g_object_get_data (G_OBJECT (so2), "test-data") == list);
+  g_object_unref (so2);
+
+  g_object_unref (list);
+}
+
+static void
+test_append_null (void)
+{
+  GtkStringList *list;
+  GtkStringObject *so;
+
+  list = new_model ((const char *[]){ NULL });
+
+  gtk_string_list_append (list, NULL);
+  gtk_string_list_take (list, NULL);
+  assert_changes (list, "+0, +1");
+
+  g_assert_null (gtk_string_list_get_string (list, 0));
+  so = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  g_assert_null (gtk_string_object_get_string (so));
+  g_object_unref (so);
+
+  g_object_unref (list);
+}
+
+static void
+test_packed (void)
+{
+  GtkStringList *list;
+  GtkStringObject *so1, *so2;
+  gboolean packed;
+
+  list = gtk_string_list_new_packed ((const char *[]){ "a", "b", "c", NULL });
+  g_object_get (list, "packed", &packed, NULL);
+  g_assert_true (packed);
+
+  gtk_string_list_splice_take_lines (list, 3, 0, g_strdup ("x\ny"), -1);
+  gtk_string_list_append (list, "z");
+  gtk_string_list_append (list, NULL);
+  g_assert_cmpuint (g_list_model_get_n_items (G_LIST_MODEL (list)), ==, 7);
+  g_assert_cmpstr (gtk_string_list_get_string (list, 4), ==, "y");
+  g_assert_null (gtk_string_list_get_string (list, 6));
+
+  so1 = g_list_model_get_item (G_LIST_MODEL (list), 2);
+  so2 = g_list_model_get_item (G_LIST_MODEL (list), 2);
+  g_assert_true (so1 == so2);
+  g_assert_cmpstr (gtk_string_object_get_string (so1), ==, "c");
+  g_object_unref (so2);
+
+  /* the object moves with its string */
+  gtk_string_list_remove (list, 0);
+  so2 = g_list_model_get_item (G_LIST_MODEL (list), 1);
+  g_assert_true (so1 == so2);
+  g_object_unref (so2);
+
+  /* objects outlive the list */
+  g_object_unref (list);
+  g_assert_cmpstr (gtk_string_object_get_string (so1), ==, "c");
+  g_object_unref (so1);
+}
+
 int
 main (int argc, char *argv[])
 {
@@ -257,6 +370,11 @@ main (int argc, char *argv[])
   g_test_add_func ("/stringlist/splice", test_splice);
   g_test_add_func ("/stringlist/add_remove", test_add_remove);
   g_test_add_func ("/stringlist/take", test_take);
+  g_test_add_func ("/stringlist/splice_bytes", test_splice_bytes);
+  g_test_add_func ("/stringlist/take_lines", test_take_lines);
+  g_test_add_func ("/stringlist/objects", test_objects);
+  g_test_add_func ("/stringlist/append_null", test_append_null);
+  g_test_add_func ("/stringlist/packed", test_packed);
 
   return g_test_run ();
 }
@@ -196,6 +196,56 @@ test_pointers_huge (void)
   g_free (a);
 }
 
+static void
+test_parallel (void)
+{
+  int *a, *b;
+  gsize i, n;
+  guint n_threads;
+
+  n = g_test_rand_int_range (100 * 1000, 500 * 1000);
+  a = g_new (int, n);
+  for (i = 0; i < n; i++)
+    a[i] = g_test_rand_int ();
+  b = g_memdup (a, sizeof (int) * n);
+
+  for (n_threads = 1; n_threads <= 8; n_threads *= 2)
+    {
+      int *c = g_memdup (a, sizeof (int) * n);
+
+      g_assert_true (gtk_tim_sort_parallel (c, n, sizeof (int), compare_int, NULL, n_threads, NULL));
+      if (n_threads == 1)
+        g_qsort_with_data (b, n, sizeof (int), compare_int, NULL);
+      assert_sort_equal (c, b, int, n);
+
+      g_free (c);
+    }
+
+  g_free (b);
+  g_free (a);
+}
+
+static void
+test_parallel_cancelled (void)
+{
+  GCancellable *cancellable;
+  int *a;
+  gsize i, n;
+
+  n = 100 * 1000;
+  a = g_new (int, n);
+  for (i = 0; i < n; i++)
+    a[i] = g_test_rand_int ();
+
+  cancellable = g_cancellable_new ();
+  g_cancellable_cancel (cancellable);
+
+  g_assert_false (gtk_tim_sort_parallel (a, n, sizeof (int), compare_int, NULL, 4, cancellable));
+
+  g_object_unref (cancellable);
+  g_free (a);
+}
+
 static void
 test_steps (void)
 {
@@ -248,6 +298,8 @@ main (int argc, char *argv[])
   g_test_add_func ("/timsort/pointers", test_pointers);
   g_test_add_func ("/timsort/pointers/huge", test_pointers_huge);
   g_test_add_func ("/timsort/steps", test_steps);
+  g_test_add_func ("/timsort/parallel", test_parallel);
+  g_test_add_func ("/timsort/parallel/cancelled", test_parallel_cancelled);
 
   return g_test_run ();
 }
@@ -334,6 +334,148 @@ test_selection_empty (void)
   g_object_unref (g_object_ref_sink (view));
 }
 
+static GtkWidget *
+height_cache_window_new (GtkListStore     *store,
+                         GtkCellRenderer **renderer,
+                         GtkWidget       **tree_view)
+{
+  GtkTreeViewColumn *column;
+  GtkWidget *window;
+
+  *tree_view = gtk_tree_view_new_with_model (GTK_TREE_MODEL (store));
+  *renderer = gtk_cell_renderer_text_new ();
+  column = gtk_tree_view_column_new_with_attributes ("Test", *renderer,
+                                                     "text", 0,
+                                                     NULL);
+  gtk_tree_view_column_set_cache_heights (column, TRUE);
+  g_assert_true (gtk_tree_view_column_get_cache_heights (column));
+  gtk_tree_view_append_column (GTK_TREE_VIEW (*tree_view), column);
+
+  window = gtk_window_new ();
+  gtk_window_set_child (GTK_WINDOW (window), *tree_view);
+  gtk_widget_show (window);
+  gtk_test_widget_wait_for_draw (window);
+
+  return window;
+}
+
+static int
+get_row_height (GtkWidget *tree_view,
+                int        row)
+{
+  GdkRectangle rect = { 0, };
+  GtkTreePath *path;
+
+  path = gtk_tree_path_new_from_indices (row, -1);
+  gtk_tree_view_get_background_area (GTK_TREE_VIEW (tree_view),
+                                     path, NULL, &rect);
+  gtk_tree_path_free (path);
+
+  return rect.height;
+}
+
+static void
+set_row_text (GtkListStore *store,
+              int           row,
+              const char   *text)
+{
+  GtkTreeIter iter;
+
+  g_assert_true (gtk_tree_model_iter_nth_child (GTK_TREE_MODEL (store), &iter, NULL, row));
+  gtk_list_store_set (store, &iter, 0, text, -1);
+}
+
+/* Rows whose cells get attribute values that were seen before
+ * reuse the cached height instead of being measured, so changing
+ * the renderer behind the column's back doesn't affect them.
+ */
+static void
+test_height_cache_reuse (void)
+{
+  GtkCellRenderer *renderer;
+  GtkListStore *store;
+  GtkWidget *window, *tree_view;
+  int height;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "a", -1);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "b", -1);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "a", -1);
+
+  window = height_cache_window_new (store, &renderer, &tree_view);
+  height = get_row_height (tree_view, 0);
+  g_assert_cmpint (get_row_height (tree_view, 2), ==, height);
+
+  g_object_set (renderer, "ypad", 20, NULL);
+  set_row_text (store, 2, "b");
+  gtk_test_widget_wait_for_draw (window);
+  g_assert_cmpint (get_row_height (tree_view, 2), ==, height);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (store);
+}
+
+/* Rows whose attribute values change to ones not seen before
+ * are measured again.
+ */
+static void
+test_height_cache_invalidate (void)
+{
+  GtkCellRenderer *renderer;
+  GtkListStore *store;
+  GtkWidget *window, *tree_view;
+  int height;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "a", -1);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "a", -1);
+
+  window = height_cache_window_new (store, &renderer, &tree_view);
+  height = get_row_height (tree_view, 0);
+
+  set_row_text (store, 1, "a\na");
+  gtk_test_widget_wait_for_draw (window);
+  g_assert_cmpint (get_row_height (tree_view, 1), >, height);
+
+  g_object_set (renderer, "ypad", 20, NULL);
+  set_row_text (store, 1, "c");
+  gtk_test_widget_wait_for_draw (window);
+  g_assert_cmpint (get_row_height (tree_view, 1), >=, height + 40);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (store);
+}
+
+/* Turning the cache off measures every row again */
+static void
+test_height_cache_disable (void)
+{
+  GtkTreeViewColumn *column;
+  GtkCellRenderer *renderer;
+  GtkListStore *store;
+  GtkWidget *window, *tree_view;
+  int height;
+
+  store = gtk_list_store_new (1, G_TYPE_STRING);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "a", -1);
+  gtk_list_store_insert_with_values (store, NULL, -1, 0, "b", -1);
+
+  window = height_cache_window_new (store, &renderer, &tree_view);
+  height = get_row_height (tree_view, 0);
+
+  column = gtk_tree_view_get_column (GTK_TREE_VIEW (tree_view), 0);
+  gtk_tree_view_column_set_cache_heights (column, FALSE);
+  g_assert_false (gtk_tree_view_column_get_cache_heights (column));
+
+  g_object_set (renderer, "ypad", 20, NULL);
+  set_row_text (store, 1, "a");
+  gtk_test_widget_wait_for_draw (window);
+  g_assert_cmpint (get_row_height (tree_view, 1), >=, height + 40);
+
+  gtk_window_destroy (GTK_WINDOW (window));
+  g_object_unref (store);
+}
+
 int
 main (int    argc,
       char **argv)
@@ -346,6 +488,12 @@ main (int    argc,
                    test_select_collapsed_row);
   g_test_add_func ("/TreeView/sizing/row-separator-height",
                    test_row_separator_height);
+  g_test_add_func ("/TreeView/sizing/height-cache-reuse",
+                   test_height_cache_reuse);
+  g_test_add_func ("/TreeView/sizing/height-cache-invalidate",
+                   test_height_cache_invalidate);
+  g_test_add_func ("/TreeView/sizing/height-cache-disable",
+                   test_height_cache_disable);
   g_test_add_func ("/TreeView/selection/count", test_selection_count);
   g_test_add_func ("/TreeView/selection/empty", test_selection_empty);
 